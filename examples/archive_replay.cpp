@@ -0,0 +1,67 @@
+/*
+Writes a small histogram archive, replays it, and checks every window against a direct calculation.
+*/
+
+#include "archive/format.hpp"
+#include "archive/mapped.hpp"
+#include "archive/replay.hpp"
+#include "inputs/symmetric.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::string path = (argc > 1) ? argv[1] : "archive_replay_example.bin";
+
+    size_t n_bins = 1000;
+    std::vector<archive_count> hist_1(n_bins), hist_2(n_bins);
+    for (size_t i = 0; i < n_bins; i++) {
+        hist_1[i] = (i * 7919) % 11;
+        hist_2[i] = (i * 104729) % 5 + ((400 <= i && i < 420) ? 30 : 0);
+    }
+
+    archive_count const* counts[] = { hist_1.data(), hist_2.data() };
+    write_archive(path, counts, 2, n_bins, 96, 0.01);
+
+    RelationParams params { 5., 2., 0.5, 1. };
+
+    for (bool likelihood_ratio : { false, true }) {
+        ReplaySettings settings { 0, 1, 50, 7, 1e-3, likelihood_ratio, 3 };
+
+        vec replayed;
+        size_t n_windows = replay_archive(MappedArchive(path), params, settings, [&](scalar const* results, size_t n_results) {
+            replayed.insert(replayed.end(), results, results + n_results);
+        });
+
+        size_t expected_windows = (n_bins - settings.window_bins) / settings.stride_bins + 1;
+        if (n_windows != expected_windows || replayed.size() != expected_windows) {
+            std::fprintf(stderr, "Expected %zu windows, got %zu\n", expected_windows, replayed.size());
+            return 1;
+        }
+
+        SymmetricRelation relation(params);
+        FactorialCache fcache;
+
+        for (size_t window_i = 0; window_i < n_windows; window_i++) {
+            size_t start = window_i * settings.stride_bins;
+            std::vector<size_t> window_1(hist_1.begin() + start, hist_1.begin() + start + settings.window_bins);
+            std::vector<size_t> window_2(hist_2.begin() + start, hist_2.begin() + start + settings.window_bins);
+
+            scalar expected = likelihood_ratio
+                ? relation.log_likelihood_ratio(fcache, window_1.data(), window_2.data(), settings.window_bins, settings.rel_precision, true)
+                : relation.log_likelihood(fcache, window_1.data(), window_2.data(), settings.window_bins, settings.rel_precision, true);
+
+            if (std::abs(expected - replayed[window_i]) > 1e-9 * std::abs(expected) + 1e-9) {
+                std::fprintf(stderr, "Window %zu: expected %.12g, replayed %.12g\n", window_i, expected, replayed[window_i]);
+                return 1;
+            }
+        }
+
+        std::printf("%s: %zu windows match\n", likelihood_ratio ? "log-likelihood ratio" : "log-likelihood", n_windows);
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
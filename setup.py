@@ -1,5 +1,6 @@
 from setuptools import setup, Extension
 from setuptools.command.build_ext import build_ext
+from setuptools.command.build_clib import build_clib
 
 from Cython.Build import cythonize
 
@@ -18,22 +19,27 @@ cpp_root = package_root + "cpp/"
 # 3rd party c++ libraries (header-only)
 cpp_lib_root = "cpplib/" 
 
+# Keep in sync with CORE_SOURCES in CMakeLists.txt
 cpp_source_files = [
+    "archive/format.cpp",
+    "calibration/background.cpp",
+    "calibration/poisson.cpp",
     "caching/factorials.cpp",
     "caching/outputs.cpp",
+    "caching/registry.cpp",
     "fast_sum/sum_terms.cpp",
     "inputs/relation.cpp",
+    "inputs/symmetric.cpp",
+    "search/lag_search.cpp",
     "util/quadratic.cpp",
+    "util/random.cpp",
 ]
 
 cython_source_files = [
     "interface.pyx",
 ]
 
-source_files = [
-    *(package_root + src_file for src_file in cython_source_files),
-    *(cpp_root + src_file for src_file in cpp_source_files)
-]
+source_files = [package_root + src_file for src_file in cython_source_files]
 
 # Locations with header files
 include_dirs = [
@@ -45,15 +51,41 @@ include_dirs = [
 # Match compiler-dependent argument format
 platform_extra_compile_args = {
     "msvc": [ f"/std:{c_std_ver}" ],
-    "unix": [ f"-std={c_std_ver}"]
+    "unix": [ f"-std={c_std_ver}", "-pthread" ]
+}
+
+platform_extra_link_args = {
+    "unix": [ "-pthread" ]
 }
 
+# The c++ core is built as a static library, which the extension links against (as does the native build in CMakeLists.txt)
+core_library = ("burstlag", {
+    "sources": [cpp_root + src_file for src_file in cpp_source_files],
+    "include_dirs": include_dirs,
+})
+
+class PlatformSpecificBuildClib(build_clib):
+    def build_libraries(self, libraries) -> None:
+        extra_compile_args = platform_extra_compile_args.get(self.compiler.compiler_type, [])
+
+        for _, build_info in libraries:
+            build_info["cflags"] = extra_compile_args
+
+        return super().build_libraries(libraries)
+
 class PlatformSpecificBuildExt(build_ext):
+    def run(self) -> None:
+        # The core library is otherwise only built by the build command, not by build_ext on its own (e.g. --inplace)
+        self.run_command("build_clib")
+        return super().run()
+
     def build_extensions(self) -> None:
         extra_compile_args = platform_extra_compile_args.get(self.compiler.compiler_type, [])
+        extra_link_args = platform_extra_link_args.get(self.compiler.compiler_type, [])
 
         for ext in self.extensions:
             ext.extra_compile_args = extra_compile_args
+            ext.extra_link_args = extra_link_args
 
         return super().build_extensions()
 
@@ -62,4 +94,4 @@ extension = Extension("*", source_files, language=c_lang)
 cython_module = cythonize(extension, build_dir=build_root, language_level=py_lang_level)
 
 # Build package
-setup(name='burst-lag', ext_modules=cython_module, include_dirs=include_dirs, cmdclass={"build_ext": PlatformSpecificBuildExt})
\ No newline at end of file
+setup(name='burst-lag', ext_modules=cython_module, libraries=[core_library], include_dirs=include_dirs, cmdclass={"build_ext": PlatformSpecificBuildExt, "build_clib": PlatformSpecificBuildClib})
\ No newline at end of file
@@ -1,2 +1,2 @@
 # type: ignore
-from .interface import DetectorRelation, FactorialCache
\ No newline at end of file
+from .interface import DetectorRelation, FactorialCache, write_archive, configure_relation_registry, clear_relation_registry, relation_registry_stats
@@ -0,0 +1,48 @@
+#include "archive/format.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+static_assert(std::endian::native == std::endian::little, "Archives are read and written in native byte order, which must be little-endian");
+
+void write_archive(std::string const& path, archive_count const* const* counts, size_t n_detectors, size_t n_bins, size_t chunk_bins, scalar bin_width) {
+    if (n_detectors == 0) throw std::invalid_argument("Archive must contain at least one detector");
+    if (chunk_bins == 0) throw std::invalid_argument("Chunks must contain at least one bin");
+
+    ArchiveHeader header {};
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.version = ARCHIVE_VERSION;
+    header.n_detectors = n_detectors;
+    header.chunk_bins = chunk_bins;
+    header.n_bins = n_bins;
+    header.bin_width = bin_width;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("Could not open archive for writing: " + path);
+
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    std::vector<archive_count> padded(chunk_bins);
+
+    for (size_t chunk_i = 0; chunk_i < header.n_chunks(); chunk_i++) {
+        size_t first_bin = chunk_i * chunk_bins;
+        size_t n_valid = std::min(chunk_bins, n_bins - first_bin);
+
+        for (size_t detector = 0; detector < n_detectors; detector++) {
+            archive_count const* source = counts[detector] + first_bin;
+
+            if (n_valid == chunk_bins) {
+                file.write(reinterpret_cast<char const*>(source), chunk_bins * sizeof(archive_count));
+            } else {
+                std::fill(std::copy(source, source + n_valid, padded.begin()), padded.end(), 0);
+                file.write(reinterpret_cast<char const*>(padded.data()), chunk_bins * sizeof(archive_count));
+            }
+        }
+    }
+
+    if (!file) throw std::runtime_error("Could not write archive: " + path);
+}
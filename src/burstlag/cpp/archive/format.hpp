@@ -0,0 +1,50 @@
+#ifndef ARCHIVE_FORMAT_H
+#define ARCHIVE_FORMAT_H
+
+#include "core.hpp"
+
+#include <cstdint>
+#include <string>
+
+/*
+Binary archive of histograms from several detectors, for replaying long runs without loading them into memory.
+
+Layout (little-endian, fixed width):
+    ArchiveHeader
+    Chunks 0 .. n_chunks - 1, each holding chunk_bins counts (archive_count) for detector 0, then detector 1, etc.
+    The final chunk is padded with zero counts.
+Every chunk, and each detector's part of it, is at a fixed offset, so the file can be memory mapped and read directly.
+*/
+
+typedef std::uint32_t archive_count;
+
+constexpr char ARCHIVE_MAGIC[8] = { 'B', 'L', 'A', 'G', 'H', 'I', 'S', 'T' };
+constexpr std::uint32_t ARCHIVE_VERSION = 1;
+
+struct ArchiveHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t n_detectors;
+    std::uint64_t chunk_bins;
+    std::uint64_t n_bins; // Per detector, excluding padding
+    double bin_width;
+    std::uint8_t reserved[24];
+
+    size_t n_chunks() const { return (n_bins + chunk_bins - 1) / chunk_bins; }
+
+    /* Offset in bytes from the start of the file to the counts of a detector in a chunk */
+    size_t chunk_offset(size_t chunk_i, size_t detector) const {
+        return sizeof(ArchiveHeader) + (chunk_i * n_detectors + detector) * chunk_bins * sizeof(archive_count);
+    }
+
+    /* Expected size of the whole file in bytes */
+    size_t file_size() const { return chunk_offset(n_chunks(), 0); }
+};
+
+static_assert(sizeof(ArchiveHeader) == 64, "Archive header must have a fixed size");
+
+/* Write an archive of n_detectors histograms, each with n_bins bins, to path.
+Throws std::invalid_argument for invalid sizes, and std::runtime_error if the file cannot be written. */
+void write_archive(std::string const& path, archive_count const* const* counts, size_t n_detectors, size_t n_bins, size_t chunk_bins, scalar bin_width);
+
+#endif
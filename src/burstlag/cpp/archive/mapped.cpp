@@ -0,0 +1,64 @@
+#include "archive/mapped.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedArchive::MappedArchive(std::string const& path) : data(nullptr), size(0), header_ptr(nullptr) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Could not open archive: " + path);
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(ArchiveHeader)) {
+        close(fd);
+        throw std::runtime_error("Archive too small to contain a header: " + path);
+    }
+
+    size = file_stat.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping remains valid
+
+    if (data == MAP_FAILED) throw std::runtime_error("Could not map archive: " + path);
+
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    header_ptr = static_cast<ArchiveHeader const*>(data);
+
+    char const* error = nullptr;
+    if (std::memcmp(header_ptr->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0) error = "Not a histogram archive: ";
+    else if (header_ptr->version != ARCHIVE_VERSION) error = "Unsupported archive version: ";
+    else if (header_ptr->n_detectors == 0 || header_ptr->chunk_bins == 0) error = "Invalid archive header: ";
+    else if (size < header_ptr->file_size()) error = "Archive is truncated: ";
+
+    if (error) {
+        munmap(data, size);
+        throw std::runtime_error(error + path);
+    }
+}
+
+MappedArchive::~MappedArchive() {
+    munmap(data, size);
+}
+
+archive_count const* MappedArchive::chunk(size_t chunk_i, size_t detector) const {
+    return reinterpret_cast<archive_count const*>(static_cast<char const*>(data) + header_ptr->chunk_offset(chunk_i, detector));
+}
+
+void MappedArchive::prefetch(size_t chunk_i) const {
+    if (chunk_i >= header_ptr->n_chunks()) return;
+
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t start = header_ptr->chunk_offset(chunk_i, 0) / page_size * page_size;
+    size_t end = header_ptr->chunk_offset(chunk_i + 1, 0);
+
+    char const* bytes = static_cast<char const*>(data);
+    madvise(const_cast<char*>(bytes) + start, end - start, MADV_WILLNEED);
+
+    // Reading one byte per page forces it to be loaded now, rather than when first used
+    volatile char sink = 0;
+    for (size_t offset = start; offset < end; offset += page_size) sink = sink + bytes[offset];
+}
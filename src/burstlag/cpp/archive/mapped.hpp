@@ -0,0 +1,32 @@
+#ifndef ARCHIVE_MAPPED_H
+#define ARCHIVE_MAPPED_H
+
+#include "archive/format.hpp"
+
+#include <string>
+
+/* Read-only memory mapping of a histogram archive (see format.hpp). Requires a POSIX system. */
+class MappedArchive {
+    void* data;
+    size_t size;
+    ArchiveHeader const* header_ptr;
+
+public:
+    /* Throws std::runtime_error if the file cannot be mapped or is not a valid archive */
+    explicit MappedArchive(std::string const& path);
+    ~MappedArchive();
+
+    MappedArchive(MappedArchive const&) = delete;
+    MappedArchive& operator=(MappedArchive const&) = delete;
+
+    ArchiveHeader const& header() const { return *header_ptr; }
+
+    /* The chunk_bins counts of a detector in a chunk */
+    archive_count const* chunk(size_t chunk_i, size_t detector) const;
+
+    /* Ask the OS to read a chunk in ahead of use, then touch each of its pages, so it is resident when used.
+    Intended to be called from a separate thread while the previous chunk is processed. Does nothing if out of range. */
+    void prefetch(size_t chunk_i) const;
+};
+
+#endif
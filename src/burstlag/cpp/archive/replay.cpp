@@ -0,0 +1,176 @@
+#include "archive/replay.hpp"
+#include "inputs/symmetric.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Number of bins claimed by a worker at once, small enough to balance bright regions, large enough to keep contention low
+constexpr size_t BINS_PER_CLAIM = 256;
+
+// Number of chunks that may be in progress at once, so workers can start the next chunk while the last is output
+constexpr size_t CHUNK_SLOTS = 2;
+
+namespace {
+    /* Per-bin values of a chunk in progress */
+    struct ChunkSlot {
+        vec bin_values;
+        std::atomic<size_t> remaining_claims; // Claims of the chunk not yet evaluated
+    };
+
+    /* Everything a worker keeps for the whole replay */
+    struct WorkerState {
+        SymmetricRelation relation;
+        FactorialCache fcache;
+        std::vector<size_t> counts_1;
+        std::vector<size_t> counts_2;
+    };
+
+    /* Evaluate bins [first, last) of a chunk into bin_values */
+    void evaluate_bins(WorkerState& state, archive_count const* chunk_1, archive_count const* chunk_2, size_t first, size_t last, ReplaySettings const& settings, scalar* bin_values) {
+        size_t n_bins = last - first;
+        state.counts_1.assign(chunk_1 + first, chunk_1 + last);
+        state.counts_2.assign(chunk_2 + first, chunk_2 + last);
+
+        if (settings.likelihood_ratio) {
+            state.relation.bin_log_likelihood_ratios(state.fcache, state.counts_1.data(), state.counts_2.data(), n_bins, settings.rel_precision, true, bin_values + first);
+        } else {
+            state.relation.bin_log_likelihoods(state.fcache, state.counts_1.data(), state.counts_2.data(), n_bins, settings.rel_precision, true, bin_values + first);
+        }
+    }
+}
+
+size_t replay_archive(MappedArchive const& archive, RelationParams const& params, ReplaySettings const& settings, ReplayOutput const& output) {
+    ArchiveHeader const& header = archive.header();
+
+    if (settings.detector_1 >= header.n_detectors || settings.detector_2 >= header.n_detectors) throw std::invalid_argument("Detector index out of range");
+    if (settings.window_bins == 0 || settings.stride_bins == 0) throw std::invalid_argument("Window and stride must be at least one bin");
+
+    size_t n_threads = settings.n_threads;
+    if (n_threads == 0) n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    size_t chunk_bins = header.chunk_bins;
+    size_t n_chunks = header.n_chunks();
+    size_t claims_per_chunk = (chunk_bins + BINS_PER_CLAIM - 1) / BINS_PER_CLAIM;
+
+    std::vector<ChunkSlot> slots(CHUNK_SLOTS);
+    for (ChunkSlot& slot : slots) {
+        slot.bin_values.resize(chunk_bins);
+        slot.remaining_claims = claims_per_chunk;
+    }
+
+    // Claims are numbered through the whole archive, claims_per_chunk per chunk (the last chunk's may be partly empty)
+    std::atomic<size_t> next_claim = 0;
+
+    std::mutex lock; // Guards the variables below, and waiting on progress
+    std::condition_variable progress;
+    size_t n_chunks_output = 0; // Chunks whose slots have been released
+    bool stop = false;
+    std::exception_ptr failure;
+
+    auto fail = [&](std::exception_ptr error) {
+        std::lock_guard guard(lock);
+        if (!failure) failure = error;
+        stop = true;
+        progress.notify_all();
+    };
+
+    auto worker = [&]() {
+        try {
+            WorkerState state { SymmetricRelation(params), {}, {}, {} };
+
+            for (size_t claim; (claim = next_claim.fetch_add(1)) < n_chunks * claims_per_chunk;) {
+                size_t chunk_i = claim / claims_per_chunk;
+                ChunkSlot& slot = slots[chunk_i % CHUNK_SLOTS];
+
+                // Wait for the chunk's slot to be released by the output stage
+                {
+                    std::unique_lock guard(lock);
+                    progress.wait(guard, [&] { return stop || chunk_i < n_chunks_output + CHUNK_SLOTS; });
+                    if (stop) return;
+                }
+
+                size_t n_valid = std::min<size_t>(chunk_bins, header.n_bins - chunk_i * chunk_bins);
+                size_t first = std::min(claim % claims_per_chunk * BINS_PER_CLAIM, n_valid);
+                size_t last = std::min(first + BINS_PER_CLAIM, n_valid);
+
+                evaluate_bins(state, archive.chunk(chunk_i, settings.detector_1), archive.chunk(chunk_i, settings.detector_2), first, last, settings, slot.bin_values.data());
+
+                if (slot.remaining_claims.fetch_sub(1) == 1) {
+                    std::lock_guard guard(lock);
+                    progress.notify_all();
+                }
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    };
+
+    // Running total of bin_values: prefix[i] is the total over bins [prefix_start, prefix_start + i)
+    vec prefix { 0 };
+    size_t prefix_start = 0;
+
+    size_t n_windows = 0; // Windows output so far
+    vec window_results;
+
+    archive.prefetch(0);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < n_threads; i++) threads.emplace_back(worker);
+
+    // Output stage: prefetch the next chunk while workers evaluate this one, then total its windows in order
+    try {
+        for (size_t chunk_i = 0; chunk_i < n_chunks; chunk_i++) {
+            ChunkSlot& slot = slots[chunk_i % CHUNK_SLOTS];
+
+            archive.prefetch(chunk_i + 1);
+
+            {
+                std::unique_lock guard(lock);
+                progress.wait(guard, [&] { return stop || slot.remaining_claims == 0; });
+                if (stop) break;
+            }
+
+            size_t first_bin = chunk_i * chunk_bins;
+            size_t n_valid = std::min<size_t>(chunk_bins, header.n_bins - first_bin);
+
+            for (size_t i = 0; i < n_valid; i++) prefix.push_back(prefix.back() + slot.bin_values[i]);
+            size_t n_processed = first_bin + n_valid;
+
+            // The slot's values are copied, so it can be reused by chunk_i + CHUNK_SLOTS
+            {
+                std::lock_guard guard(lock);
+                slot.remaining_claims = claims_per_chunk;
+                n_chunks_output++;
+                progress.notify_all();
+            }
+
+            // Output every window now complete
+            window_results.clear();
+            for (size_t start; (start = n_windows * settings.stride_bins) + settings.window_bins <= n_processed; n_windows++) {
+                window_results.push_back(prefix[start + settings.window_bins - prefix_start] - prefix[start - prefix_start]);
+            }
+            if (!window_results.empty()) output(window_results.data(), window_results.size());
+
+            // Drop totals before the next window, rebasing to keep values (and rounding errors) small
+            size_t new_start = std::min(n_windows * settings.stride_bins, n_processed);
+            scalar base = prefix[new_start - prefix_start];
+            prefix.erase(prefix.begin(), prefix.begin() + (new_start - prefix_start));
+            for (scalar& value : prefix) value -= base;
+            prefix_start = new_start;
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+
+    for (std::thread& thread : threads) thread.join();
+
+    if (failure) std::rethrow_exception(failure);
+
+    return n_windows;
+}
@@ -0,0 +1,35 @@
+#ifndef ARCHIVE_REPLAY_H
+#define ARCHIVE_REPLAY_H
+
+#include "core.hpp"
+#include "archive/mapped.hpp"
+#include "inputs/params.hpp"
+
+#include <functional>
+
+struct ReplaySettings {
+    size_t detector_1; // Index of each detector within the archive
+    size_t detector_2;
+
+    size_t window_bins; // Bins in each window
+    size_t stride_bins; // Bins between the starts of consecutive windows
+
+    scalar rel_precision;
+    bool likelihood_ratio; // Evaluate the log-likelihood ratio against background only, rather than the log-likelihood
+    size_t n_threads; // 0 for one per core
+};
+
+/* Receives consecutive windows' results, in order. Window i starts at bin i * stride_bins. */
+typedef std::function<void(scalar const* results, size_t n_windows)> ReplayOutput;
+
+/* Evaluate the log-likelihood (ratio) of every complete window in an archive, streaming through it one chunk at a time.
+
+Bins are evaluated by a fixed set of worker threads, which claim small blocks of bins in turn (so bright regions are shared out),
+each keeping its own relation (and output cache) for the whole replay. Workers may run one chunk ahead of the calling thread,
+which prefetches the next chunk and totals windows from the per-bin values in order, so overlapping windows cost no extra evaluations.
+The output callback is called from the calling thread.
+
+Returns the total number of windows. */
+size_t replay_archive(MappedArchive const& archive, RelationParams const& params, ReplaySettings const& settings, ReplayOutput const& output);
+
+#endif
@@ -1,5 +1,6 @@
 #include "caching/factorials.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 FactorialCache::FactorialCache()
@@ -14,7 +15,13 @@ size_t FactorialCache::max() const {
 }
 
 void FactorialCache::build_upto(size_t new_max_n) {
-    if (new_max_n <= max_n) return;
+    build_towards(new_max_n, new_max_n);
+}
+
+bool FactorialCache::build_towards(size_t target_max_n, size_t max_steps) {
+    if (target_max_n <= max_n) return true;
+
+    size_t new_max_n = std::min(target_max_n, max_n + max_steps);
 
     scalar running_sum = log_factorial(max_n);
 
@@ -27,6 +34,7 @@ void FactorialCache::build_upto(size_t new_max_n) {
     }
 
     max_n = new_max_n;
+    return new_max_n == target_max_n;
 }
 
 scalar FactorialCache::log_exp_series_term(scalar log_x, size_t index) const {
@@ -44,6 +52,11 @@ vec FactorialCache::exp_series(scalar x, size_t n_terms) const {
     return expansion;
 }
 
+scalar FactorialCache::log_poisson(scalar mean, size_t n) const {
+    if (n == 0) return -mean; // Avoids 0 * log(0) for mean = 0
+    return log_exp_series_term(std::log(mean), n) - mean;
+}
+
 scalar FactorialCache::log_binomial(size_t r, size_t s) const {
     return log_factorial(r + s) - log_factorial(r) - log_factorial(s);
 }
\ No newline at end of file
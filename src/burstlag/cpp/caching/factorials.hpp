@@ -18,6 +18,10 @@ public:
     /* Calculate factorials up to log(new_max_n!) */
     void build_upto(size_t new_max_n);
 
+    /* Calculate at most max_steps more factorials towards log(new_max_n!), so that large builds can be interrupted.
+    Returns whether log(new_max_n!) is now stored. */
+    bool build_towards(size_t new_max_n, size_t max_steps);
+
     /* largest n for which log(n!) is stored */
     size_t max() const;
 
@@ -33,6 +37,9 @@ public:
     /* Construct the series log(x^n / n!) for 0 <= n < n_terms */ 
     vec exp_series(scalar x, size_t n_terms) const;
 
+    /* log(mean^n e^-mean / n!), the log-probability of n from a Poisson distribution */
+    scalar log_poisson(scalar mean, size_t n) const;
+
     /* log((r+s) C r) */ 
     scalar log_binomial(size_t r, size_t s) const;
 };
@@ -0,0 +1,178 @@
+#include "caching/registry.hpp"
+
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Default memory budget for unused relations in the global registry
+constexpr size_t DEFAULT_MEMORY_BUDGET = 256 << 20;
+
+// Quantised value used for zero (e.g. zero background), which has no logarithm
+constexpr std::int64_t QUANTISED_ZERO = std::numeric_limits<std::int64_t>::min();
+
+namespace {
+    /* Approximate memory used by the registry for each entry, besides the relation: a map node and a list node */
+    template <typename Key, typename Entry>
+    constexpr size_t entry_overhead() {
+        return sizeof(std::pair<Key const, Entry>) + 3 * sizeof(void*) + sizeof(Key) + 2 * sizeof(void*);
+    }
+
+    void check_tolerance(scalar tolerance) {
+        if (!(tolerance >= 0) || std::isinf(tolerance)) throw std::invalid_argument("Tolerance must be finite and non-negative");
+    }
+}
+
+RelationRegistry::RelationRegistry(scalar tolerance, size_t memory_budget) :
+    state(std::make_shared<State>())
+{
+    check_tolerance(tolerance);
+    state->tolerance = tolerance;
+    state->memory_budget = memory_budget;
+    state->unused_memory = 0;
+}
+
+RelationRegistry& RelationRegistry::global() {
+    static RelationRegistry registry(0, DEFAULT_MEMORY_BUDGET);
+    return registry;
+}
+
+std::int64_t RelationRegistry::quantise(scalar value, scalar tolerance) {
+    if (tolerance == 0) return std::bit_cast<std::int64_t>(value);
+    if (value == 0) return QUANTISED_ZERO;
+    if (!(value > 0) || std::isinf(value)) throw std::invalid_argument("Parameters must be finite and non-negative to be quantised");
+    return std::llround(std::log(value) / std::log1p(tolerance));
+}
+
+scalar RelationRegistry::dequantise(std::int64_t quantised, scalar tolerance) {
+    if (tolerance == 0) return std::bit_cast<scalar>(quantised);
+    if (quantised == QUANTISED_ZERO) return 0;
+    return std::exp(quantised * std::log1p(tolerance));
+}
+
+RegisteredRelation RelationRegistry::get(RelationParams params) {
+    std::lock_guard guard(state->lock);
+    scalar tolerance = state->tolerance;
+
+    // Canonical order has the larger background first, or if equal, the larger sensitivity second.
+    // Relations with zero sensitivity ratio are never flipped, as the flip would have an infinite ratio.
+    bool flipped;
+    key_type key;
+
+    // The shared relation is built from these, swapped into canonical order if build_swapped
+    RelationParams build_params;
+    bool build_swapped;
+
+    if (tolerance == 0) {
+        scalar ratio = params.sensitivity_ratio_2_to_1;
+        flipped = ratio != 0 && (params.bin_background_rate_1 < params.bin_background_rate_2
+            || (params.bin_background_rate_1 == params.bin_background_rate_2 && ratio < 1));
+
+        // Never built from reciprocal parameters, which would change results depending on which order was requested first.
+        // (Sensitivities of a ratio and its reciprocal are exactly flipped, so results match in both orders.)
+        build_params = params;
+        build_swapped = flipped;
+
+        // 1 / (1 / ratio) often differs from ratio, so the canonical ratio (which may be a reciprocal) can't be keyed directly.
+        // Instead key on whichever of the given ratio and its reciprocal is at most 1, which is the same for a relation and its flip,
+        // negated if detector 2 is more sensitive in canonical order.
+        scalar reduced_ratio = (ratio > 1) ? 1 / ratio : ratio;
+        bool canonical_2_more_sensitive = flipped ? (ratio < 1) : (ratio > 1);
+
+        key = { quantise(flipped ? params.bin_background_rate_2 : params.bin_background_rate_1, 0),
+            quantise(flipped ? params.bin_background_rate_1 : params.bin_background_rate_2, 0),
+            quantise(canonical_2_more_sensitive ? -reduced_ratio : reduced_ratio, 0), quantise(params.source_suppression, 0) };
+    } else {
+        // Flipping swaps the backgrounds and negates the quantised ratio (llround is symmetric),
+        // so a relation and its flip quantise to exactly the same canonical key
+        key = { quantise(params.bin_background_rate_1, tolerance), quantise(params.bin_background_rate_2, tolerance),
+            quantise(params.sensitivity_ratio_2_to_1, tolerance), quantise(params.source_suppression, tolerance) };
+        flipped = key[2] != QUANTISED_ZERO && (key[0] < key[1] || (key[0] == key[1] && key[2] < 0));
+        if (flipped) key = { key[1], key[0], -key[2], key[3] };
+        build_params = { dequantise(key[0], tolerance), dequantise(key[1], tolerance), dequantise(key[2], tolerance), dequantise(key[3], tolerance) };
+        build_swapped = false;
+    }
+
+    auto found = state->entries.find(key);
+    if (found == state->entries.end()) {
+        found = state->entries.emplace(key, Entry { std::make_shared<SymmetricRelation>(build_params, build_swapped), 0, 0, std::nullopt }).first;
+    }
+
+    Entry& entry = found->second;
+    if (entry.unused_position) {
+        state->unused.erase(*entry.unused_position);
+        state->unused_memory -= entry.memory;
+        entry.unused_position = std::nullopt;
+    }
+    entry.n_users++;
+
+    // The handle keeps the relation alive even if dropped from the registry, and releases it when the last copy is destroyed
+    std::weak_ptr<State> weak_state = state;
+    std::shared_ptr<SymmetricRelation> handle(entry.relation.get(), [weak_state, owner = entry.relation, key](SymmetricRelation*) {
+        if (auto strong_state = weak_state.lock()) strong_state->release(key, owner.get());
+    });
+
+    return { handle, flipped };
+}
+
+void RelationRegistry::State::release(key_type const& key, SymmetricRelation const* relation) {
+    std::lock_guard guard(lock);
+
+    auto found = entries.find(key);
+    if (found == entries.end() || found->second.relation.get() != relation) return; // Dropped while in use
+
+    Entry& entry = found->second;
+    if (--entry.n_users > 0) return;
+
+    entry.memory = entry.relation->cache_memory() + entry_overhead<key_type, Entry>();
+    unused.push_front(key);
+    entry.unused_position = unused.begin();
+    unused_memory += entry.memory;
+
+    enforce_budget();
+}
+
+void RelationRegistry::State::enforce_budget() {
+    while (unused_memory > memory_budget && !unused.empty()) {
+        auto found = entries.find(unused.back());
+        unused.pop_back();
+
+        unused_memory -= found->second.memory;
+        entries.erase(found);
+    }
+}
+
+void RelationRegistry::configure(scalar tolerance, size_t memory_budget) {
+    check_tolerance(tolerance);
+
+    std::lock_guard guard(state->lock);
+
+    if (tolerance != state->tolerance) {
+        state->entries.clear();
+        state->unused.clear();
+        state->unused_memory = 0;
+    }
+
+    state->tolerance = tolerance;
+    state->memory_budget = memory_budget;
+
+    state->enforce_budget();
+}
+
+void RelationRegistry::clear() {
+    std::lock_guard guard(state->lock);
+
+    state->entries.clear();
+    state->unused.clear();
+    state->unused_memory = 0;
+}
+
+size_t RelationRegistry::size() const {
+    std::lock_guard guard(state->lock);
+    return state->entries.size();
+}
+
+size_t RelationRegistry::memory_used() const {
+    std::lock_guard guard(state->lock);
+    return state->unused_memory;
+}
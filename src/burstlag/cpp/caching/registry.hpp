@@ -0,0 +1,95 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include "core.hpp"
+#include "inputs/params.hpp"
+#include "inputs/symmetric.hpp"
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+/* A shared relation, and whether its detectors are in the opposite order to those requested */
+struct RegisteredRelation {
+    std::shared_ptr<SymmetricRelation> relation;
+    bool flipped;
+};
+
+/*
+Shares SymmetricRelations (and so their output caches) between all requests for equivalent parameters,
+so that caches stay warm when relations are recreated, e.g. for each new analysis window.
+
+Parameters are equivalent if they quantise to the same values, in steps of relative size tolerance
+(with tolerance 0 only identical parameters are equivalent). A relation and its flip are also equivalent,
+and share a single instance in a canonical detector order.
+
+Relations no longer in use (all RegisteredRelations from them destroyed) are kept, up to a memory budget, beyond which
+the least recently used are dropped. Relations in use are never dropped, and do not count towards the budget.
+Each request takes time logarithmic in the number of relations held.
+
+Requests may come from any thread, but the relations themselves are not thread-safe.
+*/
+class RelationRegistry {
+    typedef std::array<std::int64_t, 4> key_type;
+
+    struct Entry {
+        std::shared_ptr<SymmetricRelation> relation;
+        size_t n_users; // RegisteredRelations given out and not yet destroyed
+        size_t memory; // Measured when last released, counted in unused_memory while unused
+        std::optional<std::list<key_type>::iterator> unused_position; // Within unused, while unused
+    };
+
+    /* Shared with the RegisteredRelations given out, which release their entry when destroyed (if the registry still exists) */
+    struct State {
+        std::mutex lock;
+
+        scalar tolerance;
+        size_t memory_budget;
+
+        std::map<key_type, Entry> entries;
+        std::list<key_type> unused; // Keys of unused entries, most recently used first
+        size_t unused_memory; // Total memory of unused entries
+
+        /* Mark a user of the relation finished, so that it may be dropped */
+        void release(key_type const& key, SymmetricRelation const* relation);
+
+        /* Drop unused relations, least recently used first, until within budget. Requires lock. */
+        void enforce_budget();
+    };
+
+    std::shared_ptr<State> state;
+
+    /* Quantised value, the same for all values within the same step of size tolerance */
+    static std::int64_t quantise(scalar value, scalar tolerance);
+
+    /* Representative value of all values with the same quantised value */
+    static scalar dequantise(std::int64_t quantised, scalar tolerance);
+
+public:
+    RelationRegistry(scalar tolerance, size_t memory_budget);
+
+    /* The registry shared by the whole process. Initially only identical parameters are equivalent. */
+    static RelationRegistry& global();
+
+    /* Get the shared relation for the given parameters. If tolerance > 0, it is constructed from the representative
+    values of the quantised parameters, so may differ from those given (by a relative amount of up to tolerance / 2). */
+    RegisteredRelation get(RelationParams params);
+
+    /* Change the tolerance and memory budget. Changing the tolerance drops all relations (they remain valid where in use). */
+    void configure(scalar tolerance, size_t memory_budget);
+
+    /* Drop all relations (they remain valid where in use) */
+    void clear();
+
+    /* Number of relations held */
+    size_t size() const;
+
+    /* Approximate memory used by relations not in use, in bytes */
+    size_t memory_used() const;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "calibration/background.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// Number of samples claimed by a thread at once, large enough to keep contention on the shared counter low
+constexpr size_t SAMPLES_PER_CLAIM = 256;
+
+namespace {
+    /* Only used for building the tables, which need no more than a few thousand factorials in practice */
+    PoissonTable make_table(scalar mean) {
+        FactorialCache fcache;
+        return PoissonTable(fcache, mean);
+    }
+}
+
+BackgroundCalibration::BackgroundCalibration(SymmetricRelation const& relation, scalar bin_background_rate_1, scalar bin_background_rate_2) :
+    relation(relation), background_1(make_table(bin_background_rate_1)), background_2(make_table(bin_background_rate_2))
+{}
+
+void BackgroundCalibration::sample_distribution(size_t n_samples, size_t n_bins, scalar rel_precision, std::uint64_t seed, size_t n_threads, scalar* out) const {
+    if (n_threads == 0) n_threads = std::max(1u, std::thread::hardware_concurrency());
+    n_threads = std::min(n_threads, (n_samples + SAMPLES_PER_CLAIM - 1) / SAMPLES_PER_CLAIM);
+
+    std::atomic<size_t> next_sample = 0;
+
+    std::exception_ptr failure;
+    std::mutex failure_lock;
+
+    auto worker = [&]() {
+        try {
+            SymmetricRelation local_relation = relation;
+            FactorialCache fcache;
+            std::vector<size_t> counts_1(n_bins), counts_2(n_bins);
+
+            for (size_t start; (start = next_sample.fetch_add(SAMPLES_PER_CLAIM)) < n_samples;) {
+                size_t end = std::min(start + SAMPLES_PER_CLAIM, n_samples);
+
+                for (size_t sample_i = start; sample_i < end; sample_i++) {
+                    CounterRNG rng(seed, sample_i);
+
+                    for (size_t bin_i = 0; bin_i < n_bins; bin_i++) {
+                        counts_1[bin_i] = background_1.sample(rng);
+                        counts_2[bin_i] = background_2.sample(rng);
+                    }
+
+                    out[sample_i] = local_relation.log_likelihood(fcache, counts_1.data(), counts_2.data(), n_bins, rel_precision, true);
+                }
+            }
+        } catch (...) {
+            std::lock_guard guard(failure_lock);
+            if (!failure) failure = std::current_exception();
+            next_sample = n_samples; // Stop other threads early
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < n_threads; i++) threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads) thread.join();
+
+    if (failure) std::rethrow_exception(failure);
+
+    std::sort(out, out + n_samples);
+}
+
+void quantiles(scalar const* sorted_values, size_t n_values, scalar const* probabilities, size_t n_probabilities, scalar* out) {
+    if (n_values == 0) throw std::invalid_argument("Quantiles of empty distribution");
+
+    for (size_t i = 0; i < n_probabilities; i++) {
+        scalar p = probabilities[i];
+        if (!(0 <= p && p <= 1)) throw std::invalid_argument("Quantile probability outside [0, 1]");
+
+        scalar position = p * (n_values - 1);
+        size_t below = static_cast<size_t>(std::floor(position));
+        size_t above = std::min(below + 1, n_values - 1);
+        scalar fraction = position - below;
+
+        out[i] = sorted_values[below] + fraction * (sorted_values[above] - sorted_values[below]);
+    }
+}
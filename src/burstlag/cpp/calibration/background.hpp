@@ -0,0 +1,39 @@
+#ifndef BACKGROUND_H
+#define BACKGROUND_H
+
+#include "core.hpp"
+#include "inputs/symmetric.hpp"
+#include "calibration/poisson.hpp"
+
+#include <cstdint>
+
+/* Monte Carlo estimate of the distribution of the log-likelihood under background-only data,
+used to convert an observed log-likelihood into a false alarm rate. */
+class BackgroundCalibration {
+    SymmetricRelation relation;
+
+    PoissonTable background_1;
+    PoissonTable background_2;
+
+public:
+    /* relation - Detectors to evaluate the log-likelihood for.
+    bin_background_rate_1/2 - Expected number of background events per histogram bin at detector 1/2, used to simulate data.
+        These will usually match the rates the relation was constructed with.
+    */
+    BackgroundCalibration(SymmetricRelation const& relation, scalar bin_background_rate_1, scalar bin_background_rate_2);
+
+    /* Simulate n_samples background-only pairs of histograms with n_bins bins each,
+    and write their log-likelihoods into out (which must have space for n_samples values) in ascending order.
+
+    Sample i is always generated from random stream (seed, i), so the output depends only on the seed, not n_threads.
+    Each thread evaluates with its own copy of the relation, so outputs are cached within each thread.
+    n_threads = 0 uses one thread per available core.
+    */
+    void sample_distribution(size_t n_samples, size_t n_bins, scalar rel_precision, std::uint64_t seed, size_t n_threads, scalar* out) const;
+};
+
+/* Quantiles of sorted_values at each of n_probabilities probabilities (in [0, 1]), written to out.
+Linearly interpolates between values, so matches numpy.quantile with default settings. */
+void quantiles(scalar const* sorted_values, size_t n_values, scalar const* probabilities, size_t n_probabilities, scalar* out);
+
+#endif
@@ -0,0 +1,43 @@
+#include "calibration/poisson.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Width of the tabulated range, in standard deviations either side of the mean
+constexpr scalar TABLE_HALF_WIDTH = 12;
+// Extra counts included either side, so small means are fully covered
+constexpr scalar TABLE_PADDING = 20;
+
+PoissonTable::PoissonTable(FactorialCache& fcache, scalar mean) {
+    if (!(mean >= 0) || std::isinf(mean)) throw std::invalid_argument("Poisson mean must be finite and non-negative");
+
+    scalar spread = TABLE_HALF_WIDTH * std::sqrt(mean) + TABLE_PADDING;
+    min_count = static_cast<size_t>(std::max<scalar>(0, std::floor(mean - spread)));
+    size_t max_count = static_cast<size_t>(std::ceil(mean + spread));
+
+    fcache.build_upto(max_count);
+
+    cumulative.resize(max_count - min_count + 1);
+
+    // Probabilities are calculated relative to the mode, which cannot underflow
+    scalar log_mean = (mean > 0) ? std::log(mean) : 0;
+    scalar log_mode_term = fcache.log_exp_series_term(log_mean, static_cast<size_t>(mean));
+    scalar running_total = 0;
+
+    for (size_t i = 0; i < cumulative.size(); i++) {
+        size_t count = min_count + i;
+        scalar term = (mean > 0) ? std::exp(fcache.log_exp_series_term(log_mean, count) - log_mode_term) : (count == 0);
+        cumulative[i] = running_total += term;
+    }
+
+    for (scalar& value : cumulative) value /= running_total;
+}
+
+size_t PoissonTable::sample(CounterRNG& rng) const {
+    scalar u = rng.next_uniform();
+    auto found = std::upper_bound(cumulative.begin(), cumulative.end(), u);
+    if (found == cumulative.end()) --found; // Only possible through rounding of the final value
+
+    return min_count + (found - cumulative.begin());
+}
@@ -0,0 +1,21 @@
+#ifndef POISSON_H
+#define POISSON_H
+
+#include "core.hpp"
+#include "caching/factorials.hpp"
+#include "util/random.hpp"
+
+/* Samples from a Poisson distribution by inverting a precomputed table of its cumulative distribution.
+Only counts with non-negligible probability are tabulated, so the table is small even for large means.
+Sampling does not modify the table, so one instance may be shared between threads. */
+class PoissonTable {
+    size_t min_count;
+    vec cumulative; // P(X <= min_count + i), normalised to end at 1
+
+public:
+    PoissonTable(FactorialCache& fcache, scalar mean);
+
+    size_t sample(CounterRNG& rng) const;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "capi/burstlag.h"
+#include "caching/factorials.hpp"
+#include "inputs/symmetric.hpp"
+#include "calibration/background.hpp"
+
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+struct burstlag_factorial_cache {
+    FactorialCache cache;
+};
+
+struct burstlag_relation {
+    SymmetricRelation relation;
+};
+
+namespace {
+    thread_local std::string last_error;
+
+    burstlag_status fail(burstlag_status status, char const* message) {
+        last_error = message;
+        return status;
+    }
+
+    /* Run body, converting any exception into a status code, so none cross the C boundary */
+    template <typename F>
+    burstlag_status guarded(F&& body) {
+        try {
+            body();
+            return BURSTLAG_OK;
+        } catch (std::bad_alloc const& e) {
+            return fail(BURSTLAG_OUT_OF_MEMORY, e.what());
+        } catch (std::invalid_argument const& e) {
+            return fail(BURSTLAG_INVALID_ARGUMENT, e.what());
+        } catch (std::runtime_error const& e) {
+            return fail(BURSTLAG_NOT_CONVERGED, e.what());
+        } catch (std::exception const& e) {
+            return fail(BURSTLAG_UNKNOWN_ERROR, e.what());
+        } catch (...) {
+            return fail(BURSTLAG_UNKNOWN_ERROR, "Unknown exception");
+        }
+    }
+
+    bool missing(void const* pointer) {
+        return pointer == nullptr;
+    }
+}
+
+extern "C" {
+
+burstlag_factorial_cache* burstlag_factorial_cache_create(void) {
+    burstlag_factorial_cache* cache = nullptr;
+    guarded([&] { cache = new burstlag_factorial_cache(); });
+    return cache;
+}
+
+void burstlag_factorial_cache_destroy(burstlag_factorial_cache* cache) {
+    delete cache;
+}
+
+burstlag_relation* burstlag_relation_create(double bin_background_rate_1, double bin_background_rate_2, double sensitivity_ratio_2_to_1, double source_suppression) {
+    burstlag_relation* relation = nullptr;
+    guarded([&] {
+        relation = new burstlag_relation { SymmetricRelation(bin_background_rate_1, bin_background_rate_2, sensitivity_ratio_2_to_1, source_suppression) };
+    });
+    return relation;
+}
+
+void burstlag_relation_destroy(burstlag_relation* relation) {
+    delete relation;
+}
+
+burstlag_status burstlag_bin_log_likelihood(burstlag_relation* relation, burstlag_factorial_cache* cache, size_t count_1, size_t count_2, double rel_precision, int use_cache, double* out) {
+    if (missing(relation) || missing(cache) || missing(out)) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+
+    return guarded([&] {
+        *out = relation->relation.bin_log_likelihood(cache->cache, count_1, count_2, rel_precision, use_cache);
+    });
+}
+
+burstlag_status burstlag_bin_log_likelihoods(burstlag_relation* relation, burstlag_factorial_cache* cache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, double rel_precision, int use_cache, double* out) {
+    if (missing(relation) || missing(cache)) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+    if (n_bins > 0 && (missing(counts_1) || missing(counts_2) || missing(out))) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+
+    return guarded([&] {
+        relation->relation.bin_log_likelihoods(cache->cache, counts_1, counts_2, n_bins, rel_precision, use_cache, out);
+    });
+}
+
+burstlag_status burstlag_log_likelihood(burstlag_relation* relation, burstlag_factorial_cache* cache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, double rel_precision, int use_cache, double* out) {
+    if (missing(relation) || missing(cache) || missing(out)) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+    if (n_bins > 0 && (missing(counts_1) || missing(counts_2))) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+
+    return guarded([&] {
+        *out = relation->relation.log_likelihood(cache->cache, counts_1, counts_2, n_bins, rel_precision, use_cache);
+    });
+}
+
+burstlag_status burstlag_bin_log_likelihood_ratios(burstlag_relation* relation, burstlag_factorial_cache* cache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, double rel_precision, int use_cache, double* out) {
+    if (missing(relation) || missing(cache)) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+    if (n_bins > 0 && (missing(counts_1) || missing(counts_2) || missing(out))) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+
+    return guarded([&] {
+        relation->relation.bin_log_likelihood_ratios(cache->cache, counts_1, counts_2, n_bins, rel_precision, use_cache, out);
+    });
+}
+
+burstlag_status burstlag_log_likelihood_ratio(burstlag_relation* relation, burstlag_factorial_cache* cache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, double rel_precision, int use_cache, double* out) {
+    if (missing(relation) || missing(cache) || missing(out)) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+    if (n_bins > 0 && (missing(counts_1) || missing(counts_2))) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+
+    return guarded([&] {
+        *out = relation->relation.log_likelihood_ratio(cache->cache, counts_1, counts_2, n_bins, rel_precision, use_cache);
+    });
+}
+
+burstlag_status burstlag_log_likelihood_anytime(burstlag_relation* relation, burstlag_factorial_cache* cache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, double rel_precision, double time_limit, size_t max_terms, int use_cache, burstlag_anytime_result* out) {
+    if (missing(relation) || missing(cache) || missing(out)) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+    if (n_bins > 0 && (missing(counts_1) || missing(counts_2))) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+
+    return guarded([&] {
+        AnytimeResult result = relation->relation.anytime_log_likelihood(cache->cache, counts_1, counts_2, n_bins, rel_precision, time_limit, max_terms, use_cache);
+        *out = { result.log_likelihood.estimate, result.log_likelihood.lower, result.log_likelihood.upper, result.n_terms, result.complete };
+    });
+}
+
+burstlag_status burstlag_background_distribution(burstlag_relation const* relation, double bin_background_rate_1, double bin_background_rate_2, size_t n_samples, size_t n_bins, double rel_precision, uint64_t seed, size_t n_threads, double* out) {
+    if (missing(relation)) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+    if (n_samples > 0 && missing(out)) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+
+    return guarded([&] {
+        BackgroundCalibration calibration(relation->relation, bin_background_rate_1, bin_background_rate_2);
+        calibration.sample_distribution(n_samples, n_bins, rel_precision, seed, n_threads, out);
+    });
+}
+
+burstlag_status burstlag_quantiles(double const* sorted_values, size_t n_values, double const* probabilities, size_t n_probabilities, double* out) {
+    if (missing(sorted_values) || (n_probabilities > 0 && (missing(probabilities) || missing(out)))) return fail(BURSTLAG_INVALID_ARGUMENT, "Null pointer argument");
+
+    return guarded([&] {
+        quantiles(sorted_values, n_values, probabilities, n_probabilities, out);
+    });
+}
+
+char const* burstlag_last_error(void) {
+    return last_error.c_str();
+}
+
+}
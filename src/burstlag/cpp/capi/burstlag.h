@@ -0,0 +1,137 @@
+#ifndef BURSTLAG_C_H
+#define BURSTLAG_C_H
+
+/*
+C interface to the likelihood calculator, for use without Python.
+
+Objects are opaque and must be released with the matching _destroy function.
+Neither type is thread-safe: each thread should create its own cache and relation.
+Functions that can fail return a burstlag_status, and a description of the last failure on the calling thread
+is available from burstlag_last_error().
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum burstlag_status {
+    BURSTLAG_OK = 0,
+    BURSTLAG_INVALID_ARGUMENT,
+    BURSTLAG_NOT_CONVERGED, /* The likelihood sum did not converge as expected (this generally indicates a bug) */
+    BURSTLAG_OUT_OF_MEMORY,
+    BURSTLAG_UNKNOWN_ERROR
+} burstlag_status;
+
+/* Stores calculated values of log integers and factorials, see FactorialCache */
+typedef struct burstlag_factorial_cache burstlag_factorial_cache;
+
+/* Parameters of a pair of detectors, and a cache of previous outputs, see DetectorRelation */
+typedef struct burstlag_relation burstlag_relation;
+
+/* Returns NULL on failure */
+burstlag_factorial_cache* burstlag_factorial_cache_create(void);
+
+void burstlag_factorial_cache_destroy(burstlag_factorial_cache* cache);
+
+/* Parameters are as for the DetectorRelation constructor. Returns NULL on failure. */
+burstlag_relation* burstlag_relation_create(
+    double bin_background_rate_1,
+    double bin_background_rate_2,
+    double sensitivity_ratio_2_to_1,
+    double source_suppression
+);
+
+void burstlag_relation_destroy(burstlag_relation* relation);
+
+/* Log-likelihood of a single pair of counts, written to *out.
+use_cache is non-zero to use the relation's cache of previous outputs. */
+burstlag_status burstlag_bin_log_likelihood(
+    burstlag_relation* relation, burstlag_factorial_cache* cache,
+    size_t count_1, size_t count_2,
+    double rel_precision, int use_cache,
+    double* out
+);
+
+/* Log-likelihood of each of n_bins pairs of counts, written to out[0 .. n_bins). */
+burstlag_status burstlag_bin_log_likelihoods(
+    burstlag_relation* relation, burstlag_factorial_cache* cache,
+    size_t const* counts_1, size_t const* counts_2, size_t n_bins,
+    double rel_precision, int use_cache,
+    double* out
+);
+
+/* Total log-likelihood of a pair of histograms with n_bins bins each, written to *out. */
+burstlag_status burstlag_log_likelihood(
+    burstlag_relation* relation, burstlag_factorial_cache* cache,
+    size_t const* counts_1, size_t const* counts_2, size_t n_bins,
+    double rel_precision, int use_cache,
+    double* out
+);
+
+/* Log of the ratio between the likelihoods of a coincident burst and of background only, for each of n_bins pairs of counts,
+written to out[0 .. n_bins). Ratios are cached separately from likelihoods when use_cache is non-zero. */
+burstlag_status burstlag_bin_log_likelihood_ratios(
+    burstlag_relation* relation, burstlag_factorial_cache* cache,
+    size_t const* counts_1, size_t const* counts_2, size_t n_bins,
+    double rel_precision, int use_cache,
+    double* out
+);
+
+/* Total log-likelihood ratio of a pair of histograms with n_bins bins each, written to *out.
+Both hypotheses are evaluated in a single pass over the bins. */
+burstlag_status burstlag_log_likelihood_ratio(
+    burstlag_relation* relation, burstlag_factorial_cache* cache,
+    size_t const* counts_1, size_t const* counts_2, size_t n_bins,
+    double rel_precision, int use_cache,
+    double* out
+);
+
+typedef struct burstlag_anytime_result {
+    double estimate;
+    double lower; /* The true log-likelihood lies in [lower, upper] */
+    double upper;
+    size_t n_terms; /* Number of terms evaluated */
+    int complete; /* Non-zero if every bin reached rel_precision */
+} burstlag_anytime_result;
+
+/* Total log-likelihood of a pair of histograms, within a budget of time_limit seconds (INFINITY for none)
+and approximately max_terms terms (SIZE_MAX for none), with rigorous bounds, written to *out.
+The budget is shared between bins, prioritising the most uncertain. Bins not started within the budget use looser closed form bounds, so bounds are always finite. */
+burstlag_status burstlag_log_likelihood_anytime(
+    burstlag_relation* relation, burstlag_factorial_cache* cache,
+    size_t const* counts_1, size_t const* counts_2, size_t n_bins,
+    double rel_precision, double time_limit, size_t max_terms, int use_cache,
+    burstlag_anytime_result* out
+);
+
+/* Simulate n_samples background-only pairs of histograms with n_bins bins each, using the given background rates,
+and write their log-likelihoods into out[0 .. n_samples) in ascending order.
+The output depends only on the seed, not on n_threads (0 uses one thread per core).
+The relation is copied for each thread, so it is not modified. */
+burstlag_status burstlag_background_distribution(
+    burstlag_relation const* relation,
+    double bin_background_rate_1, double bin_background_rate_2,
+    size_t n_samples, size_t n_bins,
+    double rel_precision, uint64_t seed, size_t n_threads,
+    double* out
+);
+
+/* Linearly interpolated quantiles of sorted_values (such as the output of burstlag_background_distribution),
+at each probability in [0, 1], written to out[0 .. n_probabilities). */
+burstlag_status burstlag_quantiles(
+    double const* sorted_values, size_t n_values,
+    double const* probabilities, size_t n_probabilities,
+    double* out
+);
+
+/* Description of the most recent error on this thread, or an empty string */
+char const* burstlag_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
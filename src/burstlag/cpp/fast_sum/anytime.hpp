@@ -0,0 +1,159 @@
+#ifndef ANYTIME_H
+#define ANYTIME_H
+
+#include "fast_sum/converging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/* Bounds on a log-likelihood (or other log-sum). estimate is the best single value, with lower <= estimate <= upper. */
+struct LikelihoodInterval {
+    scalar estimate;
+    scalar lower;
+    scalar upper;
+};
+
+/* Maximum relative error of fast_exp, which every term is evaluated with */
+constexpr scalar FAST_EXP_REL_ERROR = 0.03;
+
+/*
+Interruptible alternative to log_sum_exp, which can be stopped after any number of terms and still bound the total.
+
+Terms are evaluated roughly in decreasing order: starting from the lead term of the lead row, each step takes the
+largest next term from any frontier, i.e. the next row outwards from the lead row, or the next term outwards along
+a row already started. Using the same structure as log_sum_exp (one peak in each row, and row peaks decreasing away
+from the lead row), no remaining term along a frontier can exceed its next term, which bounds the remaining total.
+*/
+template <PeakedLazyArray2D<scalar> A2>
+class AnytimeSum {
+    /* The next term to evaluate along one direction */
+    struct Frontier {
+        scalar term; // Rescaled value of the next term
+        size_t row;
+        size_t index; // Within row, or the lead index of row if new_row
+        bool forward; // Direction of travel: increasing or decreasing indices
+        bool new_row; // Moving between rows, rather than along one
+
+        bool operator<(Frontier const& other) const { return term < other.term; }
+    };
+
+    A2 log_terms;
+    scalar log_rescale;
+    scalar total;
+    size_t n_terms;
+
+    std::vector<Frontier> frontiers; // Max-heap by term
+    scalar running_bound; // Total of frontier_bound over frontiers, updated as they change (so subject to rounding)
+
+    /* Evaluate the frontier's next term and add it to the heap, unless it is out of bounds */
+    void push(size_t row, size_t index, bool forward, bool new_row) {
+        // Indices 'below 0' wrap to large values
+        if (row >= log_terms.size_1() || index >= log_terms.size_2()) return;
+
+        frontiers.push_back({ exp_scaled(log_terms.get(row, index), log_rescale), row, index, forward, new_row });
+        std::push_heap(frontiers.begin(), frontiers.end());
+        running_bound += frontier_bound(frontiers.back());
+        n_terms++;
+    }
+
+    void push_row(size_t row, bool forward) {
+        if (row >= log_terms.size_1()) return;
+        push(row, log_terms.lead_index_2(row), forward, true);
+    }
+
+    /* Start each direction along a row from its lead */
+    void push_row_tails(size_t row, size_t lead_index) {
+        push(row, lead_index - 1, false, false);
+        push(row, lead_index + 1, true, false);
+    }
+
+    /* Upper bound on the total of all terms still to be evaluated along a frontier */
+    scalar frontier_bound(Frontier const& frontier) const {
+        if (frontier.new_row) {
+            size_t n_rows = frontier.forward ? (log_terms.size_1() - frontier.row) : (frontier.row + 1);
+            return frontier.term * n_rows * log_terms.size_2();
+        }
+
+        size_t n_remaining = frontier.forward ? (log_terms.size_2() - frontier.index) : (frontier.index + 1);
+        return frontier.term * n_remaining;
+    }
+
+public:
+    /* Evaluates the lead term and the first term of each frontier around it */
+    AnytimeSum(A2 log_terms) : log_terms(log_terms), total(1), n_terms(1), running_bound(0) {
+        size_t lead_row = this->log_terms.lead_index_1();
+        size_t lead_index = this->log_terms.lead_index_2(lead_row);
+        log_rescale = this->log_terms.get(lead_row, lead_index);
+
+        push_row_tails(lead_row, lead_index);
+        push_row(lead_row - 1, false);
+        push_row(lead_row + 1, true);
+    }
+
+    /* Total number of terms evaluated so far */
+    size_t terms_evaluated() const { return n_terms; }
+
+    /* Upper bound on the (rescaled) total of all terms not yet included. Takes time proportional to the number of frontiers. */
+    scalar remaining() const {
+        scalar bound = 0;
+        for (Frontier const& frontier : frontiers) bound += frontier_bound(frontier);
+        return bound;
+    }
+
+    /* If the remaining terms are known to be negligible at rel_precision (or there are none) */
+    bool finished(scalar rel_precision) const {
+        if (frontiers.empty()) return true;
+        // The running bound is only used to decide when to check exactly
+        return running_bound < total * rel_precision && remaining() < total * rel_precision;
+    }
+
+    /* Approximate bound on the absolute error in the log of the total from unevaluated terms, for prioritising work */
+    scalar log_uncertainty() const {
+        return std::log1p(std::max<scalar>(running_bound, 0) / total);
+    }
+
+    /* Include roughly max_terms more terms (each step may evaluate up to 3), stopping early if finished at rel_precision.
+    Returns the number evaluated. */
+    size_t step(size_t max_terms, scalar rel_precision) {
+        size_t start_terms = n_terms;
+
+        while (n_terms - start_terms < max_terms && !frontiers.empty()) {
+            if (running_bound < total * rel_precision) {
+                running_bound = remaining(); // Remove accumulated rounding before relying on it
+                if (running_bound < total * rel_precision) break;
+            }
+
+            std::pop_heap(frontiers.begin(), frontiers.end());
+            Frontier next = frontiers.back();
+            frontiers.pop_back();
+
+            total += next.term;
+            running_bound -= frontier_bound(next);
+
+            size_t step_direction = next.forward ? 1 : -1; // Wraps, as for indices
+
+            if (next.new_row) {
+                push_row_tails(next.row, next.index);
+                push_row(next.row + step_direction, next.forward);
+            } else {
+                push(next.row, next.index + step_direction, next.forward, false);
+            }
+        }
+
+        return n_terms - start_terms;
+    }
+
+    /* Bounds on the log of the total, allowing for unevaluated terms and the error of fast_exp */
+    LikelihoodInterval log_total() const {
+        scalar bound = remaining();
+        return {
+            std::log(total + bound / 2) + log_rescale,
+            std::log(total / (1 + FAST_EXP_REL_ERROR)) + log_rescale,
+            std::log((total + bound) / (1 - FAST_EXP_REL_ERROR)) + log_rescale
+        };
+    }
+};
+
+#endif
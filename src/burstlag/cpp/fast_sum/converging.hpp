@@ -19,7 +19,7 @@ They rely on the terms having a very specific structure (one peak in each row/co
 This must be done for every term included in the total, and exp is slow,
 so this is the chokepoint of th entire operation.
  */
-scalar exp_scaled(scalar log_x, scalar log_rescale) {
+inline scalar exp_scaled(scalar log_x, scalar log_rescale) {
     scalar log_scaled = log_x - log_rescale;
 
     if (log_scaled == 0) return 1;
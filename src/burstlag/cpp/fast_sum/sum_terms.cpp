@@ -77,6 +77,17 @@ size_t BinSumTerms::lead_index_1() const {
     return peak_index(0, count_1);
 }
 
-scalar BinSumTerms::log_likelihood_prefactor() const {
+scalar BinSumTerms::log_likelihood_prefactor(DetectorRelation const& detectors, size_t count_1, size_t count_2) {
     return detectors.log_sensitivity.first * count_1 + detectors.log_sensitivity.second * count_2 + detectors.log_const_prefactor;
+}
+
+scalar BinSumTerms::log_likelihood_prefactor() const {
+    return log_likelihood_prefactor(detectors, count_1, count_2);
+}
+
+scalar_pair BinSumTerms::log_likelihood_bounds(DetectorRelation const& detectors, size_t count_1, size_t count_2) {
+    scalar log_first_term = std::lgamma(count_1 + count_2 + 1.) - std::lgamma(count_1 + 1.) - std::lgamma(count_2 + 1.);
+    scalar lower = log_likelihood_prefactor(detectors, count_1, count_2) + log_first_term;
+
+    return { lower, lower + detectors.rate_const.first + detectors.rate_const.second };
 }
\ No newline at end of file
@@ -34,6 +34,9 @@ class BinSumTerms {
         return (first.second > second.second) ? peak_index(first, others...) : peak_index(second, others...);
     }
 
+    /* Normalisation value shared by all terms, see log_likelihood_prefactor */
+    static scalar log_likelihood_prefactor(DetectorRelation const& detectors, size_t count_1, size_t count_2);
+
     /* Special case of peak_index defined above, to allow recursive definition*/
     size_t peak_index(i_val only) const {
         return only.first;
@@ -59,6 +62,11 @@ public:
     
     /* Constant normalisation value added to all log-likelihoods calculated */
     scalar log_likelihood_prefactor() const;
+
+    /* Lower and upper bounds on the log-likelihood, in constant time without evaluating any terms or needing factorials.
+    The total of the terms is at least the first, log((count_1 + count_2) C count_1), and at most e^(alpha + rho) times that,
+    as the binomial factor only decreases away from the first term, and each exponential series is bounded by its infinite sum. */
+    static scalar_pair log_likelihood_bounds(DetectorRelation const& detectors, size_t count_1, size_t count_2);
 };
 
 #endif
\ No newline at end of file
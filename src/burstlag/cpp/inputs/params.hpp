@@ -0,0 +1,27 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include "core.hpp"
+
+/* The parameters a DetectorRelation is constructed from (see its public constructor),
+kept so that equivalent relations can be rebuilt, e.g. for rebinned histograms. */
+struct RelationParams {
+    scalar bin_background_rate_1;
+    scalar bin_background_rate_2;
+    scalar sensitivity_ratio_2_to_1;
+    scalar source_suppression;
+
+    /* Parameters for histograms where each bin is the sum of `factor` adjacent bins.
+    Background rates per bin scale with the bin width. The sensitivity ratio is unchanged, as the expected signal at
+    both detectors scales by the same factor, and the suppression prior is left as it is. */
+    RelationParams rebinned(size_t factor) const {
+        return { bin_background_rate_1 * factor, bin_background_rate_2 * factor, sensitivity_ratio_2_to_1, source_suppression };
+    }
+
+    /* Parameters for the same detectors in the opposite order */
+    RelationParams flipped() const {
+        return { bin_background_rate_2, bin_background_rate_1, 1 / sensitivity_ratio_2_to_1, source_suppression };
+    }
+};
+
+#endif
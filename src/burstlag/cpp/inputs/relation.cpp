@@ -2,21 +2,27 @@
 #include "fast_sum/sum_terms.hpp"
 #include "fast_sum/converging.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <optional>
 
-DetectorRelation::DetectorRelation(scalar_pair log_sensitivity, scalar_pair rate_const, scalar_pair log_rate_const, scalar log_const_prefactor) :
-    log_sensitivity(log_sensitivity), rate_const(rate_const), log_rate_const(log_rate_const), log_const_prefactor(log_const_prefactor)
+DetectorRelation::DetectorRelation(scalar_pair log_sensitivity, scalar_pair rate_const, scalar_pair log_rate_const, scalar log_const_prefactor, scalar_pair background_rate) :
+    log_sensitivity(log_sensitivity), rate_const(rate_const), log_rate_const(log_rate_const), log_const_prefactor(log_const_prefactor), background_rate(background_rate)
 {}
 
 DetectorRelation::DetectorRelation(scalar_pair bin_background_rate, scalar_pair sensitivity, scalar log_suppression_prefactor) :
     log_sensitivity(log(sensitivity)),
     rate_const(bin_background_rate / sensitivity),
     log_rate_const(log(rate_const)),
-    log_const_prefactor(log_suppression_prefactor - sum(bin_background_rate))
+    log_const_prefactor(log_suppression_prefactor - sum(bin_background_rate)),
+    background_rate(bin_background_rate)
 {}
 
+/* Calculated from whichever of the ratio and its reciprocal is at most 1, so that a ratio and its (rounded) reciprocal
+give exactly flipped sensitivities, and equivalent relations in either detector order evaluate identically */
 inline scalar_pair sensitivities_from_ratio(scalar sensitivity_ratio_2_to_1) {
+    if (sensitivity_ratio_2_to_1 > 1) return flip_pair(sensitivities_from_ratio(1 / sensitivity_ratio_2_to_1));
+
     scalar sensitivity_1 = 1 / (1 + sensitivity_ratio_2_to_1);
     return { sensitivity_1, 1 - sensitivity_1 };
 }
@@ -31,23 +37,17 @@ DetectorRelation::DetectorRelation(scalar bin_background_rate_1, scalar bin_back
 DetectorRelation::DetectorRelation() : DetectorRelation(0, 0, 1, 1) {}
 
 DetectorRelation DetectorRelation::flip() {
-    return DetectorRelation(flip_pair(log_sensitivity), flip_pair(rate_const), flip_pair(log_rate_const), log_const_prefactor);
+    return DetectorRelation(flip_pair(log_sensitivity), flip_pair(rate_const), flip_pair(log_rate_const), log_const_prefactor, flip_pair(background_rate));
 }
 
-scalar DetectorRelation::bin_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2, scalar rel_precision, bool use_cache) {
-    likelihood_args arg_key = { count_1, count_2, rel_precision };
-
-    if (use_cache) {
-        if (auto cache_item = previous_outputs.find(arg_key); cache_item != previous_outputs.end()) {
-            return cache_item->second;
-        }
-    }
-
+scalar DetectorRelation::bin_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2, scalar rel_precision) {
     BinSumTerms terms(fcache, *this, count_1, count_2);
 
-    scalar result = terms.log_likelihood_prefactor() + log_sum_exp(terms, rel_precision);
+    return terms.log_likelihood_prefactor() + log_sum_exp(terms, rel_precision);
+}
+
+scalar DetectorRelation::bin_background_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2) const {
+    fcache.build_upto(std::max(count_1, count_2));
 
-    if (use_cache) previous_outputs[arg_key] = result;
-    
-    return result;
-}
\ No newline at end of file
+    return fcache.log_poisson(background_rate.first, count_1) + fcache.log_poisson(background_rate.second, count_2);
+}
@@ -3,10 +3,8 @@
 
 #include "core.hpp"
 #include "caching/factorials.hpp"
-#include "caching/outputs.hpp"
 #include "util/pair_ops.hpp"
 
-#include <unordered_map>
 #include <utility>
 
 /* Encodes information about relative rates of both detectors */
@@ -26,8 +24,10 @@ class DetectorRelation {
 
     scalar log_const_prefactor; // - (b + q) + (log(1-1/k) if k>1, else 0)
 
+    scalar_pair background_rate; // = b, q
+
     /* Simplest constructor, directly sets attributes */
-    DetectorRelation(scalar_pair log_sensitivity, scalar_pair rate_const, scalar_pair log_rate_const, scalar log_const_prefactor);
+    DetectorRelation(scalar_pair log_sensitivity, scalar_pair rate_const, scalar_pair log_rate_const, scalar log_const_prefactor, scalar_pair background_rate);
 
     /* Intermediate constructor, used internally.
     Defines attributes from:
@@ -38,9 +38,6 @@ class DetectorRelation {
     */
     DetectorRelation(scalar_pair bin_background_rate, scalar_pair sensitivity, scalar log_suppression_prefactor);
 
-    /* Cache of calculated likelihoods for reuse */
-    std::unordered_map<likelihood_args, scalar, hash_args> previous_outputs;
-
     friend class BinSumTerms;
 
 public:
@@ -62,12 +59,16 @@ public:
     DetectorRelation flip();
     
     /* Returns the log_likelihood of the given observed neutrino counts to specified rel_precision.
-        use_cache specifies whether to use the output cache - that remembers previous inputs and their outputs.
         fcache stores calculate factorials, and is *always* used
         rel_precision specifies the desired maximum error, relative to the value of the likelihood. 
             This corresponds approximately to the maximum absolute error of the calculated log-likelihood.
+    Outputs are not cached here, but by SymmetricRelation, so that both detector orders share one cache.
     */
-    scalar bin_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2, scalar rel_precision, bool use_cache);
+    scalar bin_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2, scalar rel_precision);
+
+    /* Returns the log-likelihood of the given counts under the background-only hypothesis,
+    i.e. independent Poisson counts with the background rate at each detector. This is exact. */
+    scalar bin_background_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2) const;
 };
 
 #endif
\ No newline at end of file
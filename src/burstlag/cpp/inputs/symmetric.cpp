@@ -0,0 +1,233 @@
+#include "inputs/symmetric.hpp"
+#include "fast_sum/sum_terms.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <queue>
+
+// Terms evaluated for a bin before reconsidering which bin is most uncertain
+constexpr size_t ANYTIME_STEP_TERMS = 32;
+
+// Factorials built between checks of the time limit, taking well under a millisecond
+constexpr size_t ANYTIME_FACTORIAL_STEP = 4096;
+
+namespace {
+    DetectorRelation make_relation(RelationParams const& params, bool swapped) {
+        DetectorRelation relation(params.bin_background_rate_1, params.bin_background_rate_2, params.sensitivity_ratio_2_to_1, params.source_suppression);
+        return swapped ? relation.flip() : relation;
+    }
+}
+
+SymmetricRelation::SymmetricRelation(RelationParams params, bool swapped) :
+    params(params),
+    swapped(swapped),
+    forward(make_relation(params, swapped)),
+    flipped(forward.flip())
+{}
+
+SymmetricRelation::SymmetricRelation(RelationParams params) : SymmetricRelation(params, false) {}
+
+SymmetricRelation::SymmetricRelation(scalar bin_background_rate_1, scalar bin_background_rate_2, scalar sensitivity_ratio_2_to_1, scalar source_suppression) :
+    SymmetricRelation(RelationParams { bin_background_rate_1, bin_background_rate_2, sensitivity_ratio_2_to_1, source_suppression })
+{}
+
+SymmetricRelation::SymmetricRelation() : SymmetricRelation(0, 0, 1, 1) {}
+
+namespace {
+    /* Approximate memory used by a node-based hashmap: each element is a node with a pointer to the next, plus the bucket array.
+    Empty maps are counted as using none, as they allocate no buckets. */
+    template <typename K, typename V, typename H>
+    size_t hashmap_memory(std::unordered_map<K, V, H> const& map) {
+        if (map.empty()) return 0;
+        return map.size() * (sizeof(std::pair<K const, V>) + sizeof(void*) + sizeof(size_t)) + map.bucket_count() * sizeof(void*);
+    }
+}
+
+size_t SymmetricRelation::cache_memory() const {
+    return sizeof(SymmetricRelation) + hashmap_memory(previous_outputs) + hashmap_memory(previous_ratios) + hashmap_memory(previous_intervals);
+}
+
+scalar SymmetricRelation::bin_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2, scalar rel_precision, bool use_cache) {
+    likelihood_args arg_key = { count_1, count_2, rel_precision };
+
+    if (use_cache) {
+        if (auto cache_item = previous_outputs.find(arg_key); cache_item != previous_outputs.end()) {
+            return cache_item->second;
+        }
+    }
+
+    scalar result = (count_1 > count_2)
+        ? forward.bin_log_likelihood(fcache, count_1, count_2, rel_precision)
+        : flipped.bin_log_likelihood(fcache, count_2, count_1, rel_precision);
+
+    if (use_cache) previous_outputs[arg_key] = result;
+
+    return result;
+}
+
+void SymmetricRelation::bin_log_likelihoods(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, bool use_cache, scalar* out) {
+    for (size_t i = 0; i < n_bins; i++) {
+        out[i] = bin_log_likelihood(fcache, counts_1[i], counts_2[i], rel_precision, use_cache);
+    }
+}
+
+scalar SymmetricRelation::log_likelihood(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, bool use_cache) {
+    scalar total = 0;
+
+    for (size_t i = 0; i < n_bins; i++) {
+        total += bin_log_likelihood(fcache, counts_1[i], counts_2[i], rel_precision, use_cache);
+    }
+
+    return total;
+}
+
+scalar SymmetricRelation::bin_background_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2) const {
+    return forward.bin_background_log_likelihood(fcache, count_1, count_2);
+}
+
+scalar SymmetricRelation::bin_log_likelihood_ratio(FactorialCache& fcache, size_t count_1, size_t count_2, scalar rel_precision, bool use_cache) {
+    likelihood_args arg_key = { count_1, count_2, rel_precision };
+
+    if (use_cache) {
+        if (auto cache_item = previous_ratios.find(arg_key); cache_item != previous_ratios.end()) {
+            return cache_item->second;
+        }
+    }
+
+    scalar result = bin_log_likelihood(fcache, count_1, count_2, rel_precision, use_cache) - bin_background_log_likelihood(fcache, count_1, count_2);
+
+    if (use_cache) previous_ratios[arg_key] = result;
+
+    return result;
+}
+
+void SymmetricRelation::bin_log_likelihood_ratios(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, bool use_cache, scalar* out) {
+    for (size_t i = 0; i < n_bins; i++) {
+        out[i] = bin_log_likelihood_ratio(fcache, counts_1[i], counts_2[i], rel_precision, use_cache);
+    }
+}
+
+scalar SymmetricRelation::log_likelihood_ratio(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, bool use_cache) {
+    scalar total = 0;
+
+    for (size_t i = 0; i < n_bins; i++) {
+        total += bin_log_likelihood_ratio(fcache, counts_1[i], counts_2[i], rel_precision, use_cache);
+    }
+
+    return total;
+}
+
+AnytimeResult SymmetricRelation::anytime_log_likelihood(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, scalar time_limit, size_t max_terms, bool use_cache) {
+    typedef std::chrono::steady_clock clock;
+    auto start_time = clock::now();
+
+    size_t n_terms = 0;
+    auto budget_exhausted = [&]() {
+        return n_terms >= max_terms || std::chrono::duration<scalar>(clock::now() - start_time).count() >= time_limit;
+    };
+
+    // Each distinct pair of counts, with the number of bins it occurs in
+    std::map<std::pair<size_t, size_t>, size_t> multiplicities;
+    for (size_t i = 0; i < n_bins; i++) multiplicities[{ counts_1[i], counts_2[i] }]++;
+
+    struct BinState {
+        likelihood_args key;
+        size_t multiplicity;
+        bool is_forward; // Evaluated in the original order, rather than flipped (as in bin_log_likelihood)
+        scalar_pair seed; // Closed form bounds, used until the sum is started
+        scalar log_prefactor;
+        std::optional<AnytimeSum<BinSumTerms>> sum;
+        std::optional<LikelihoodInterval> cached;
+    };
+
+    std::vector<BinState> states;
+    states.reserve(multiplicities.size());
+
+    for (auto [counts, multiplicity] : multiplicities) {
+        BinState& state = states.emplace_back(BinState { { counts.first, counts.second, rel_precision }, multiplicity, counts.first > counts.second, { 0, 0 }, 0, std::nullopt, std::nullopt });
+
+        if (use_cache) {
+            if (auto cache_item = previous_intervals.find(state.key); cache_item != previous_intervals.end()) {
+                state.cached = cache_item->second;
+                continue;
+            }
+        }
+
+        state.seed = state.is_forward
+            ? BinSumTerms::log_likelihood_bounds(forward, counts.first, counts.second)
+            : BinSumTerms::log_likelihood_bounds(flipped, counts.second, counts.first);
+    }
+
+    // The seed width, alpha + rho, is the same for every bin (in either order), so unstarted bins are ordered only by
+    // multiplicity, and ties are broken arbitrarily (by index).
+    auto priority = [&](size_t state_i) {
+        BinState const& state = states[state_i];
+        scalar uncertainty = state.sum ? state.sum->log_uncertainty() : (state.seed.second - state.seed.first);
+        return state.multiplicity * uncertainty;
+    };
+
+    std::priority_queue<std::pair<scalar, size_t>> unfinished;
+    for (size_t i = 0; i < states.size(); i++) {
+        if (!states[i].cached) unfinished.push({ priority(i), i });
+    }
+
+    while (!unfinished.empty() && !budget_exhausted()) {
+        size_t state_i = unfinished.top().second;
+        BinState& state = states[state_i];
+
+        if (!state.sum) {
+            auto [count_1, count_2] = std::get<0>(state.key) > std::get<1>(state.key)
+                ? std::pair(std::get<0>(state.key), std::get<1>(state.key))
+                : std::pair(std::get<1>(state.key), std::get<0>(state.key));
+
+            bool built;
+            while (!(built = fcache.build_towards(count_1 + count_2, ANYTIME_FACTORIAL_STEP)) && !budget_exhausted()) {}
+            if (!built) break;
+
+            BinSumTerms terms = state.is_forward
+                ? BinSumTerms(fcache, forward, count_1, count_2)
+                : BinSumTerms(fcache, flipped, count_1, count_2);
+
+            state.log_prefactor = terms.log_likelihood_prefactor();
+            state.sum.emplace(terms);
+            n_terms += state.sum->terms_evaluated();
+        } else {
+            n_terms += state.sum->step(std::min(ANYTIME_STEP_TERMS, max_terms - n_terms), rel_precision);
+        }
+
+        unfinished.pop();
+        if (!state.sum->finished(rel_precision)) unfinished.push({ priority(state_i), state_i });
+    }
+
+    AnytimeResult result { { 0, 0, 0 }, n_terms, true };
+
+    for (BinState const& state : states) {
+        LikelihoodInterval bin;
+
+        if (state.cached) {
+            bin = *state.cached;
+        } else if (state.sum) {
+            LikelihoodInterval log_total = state.sum->log_total();
+            bin = { state.log_prefactor + log_total.estimate, state.log_prefactor + log_total.lower, state.log_prefactor + log_total.upper };
+
+            if (state.sum->finished(rel_precision)) {
+                if (use_cache) previous_intervals[state.key] = bin;
+            } else {
+                result.complete = false;
+            }
+        } else {
+            // As for AnytimeSum::log_total, the estimate is halfway between the bounds on the likelihood (not its log)
+            auto [lower, upper] = state.seed;
+            bin = { upper + std::log1p(std::exp(lower - upper)) - std::log(2.), lower, upper };
+            result.complete = false;
+        }
+
+        result.log_likelihood.estimate += state.multiplicity * bin.estimate;
+        result.log_likelihood.lower += state.multiplicity * bin.lower;
+        result.log_likelihood.upper += state.multiplicity * bin.upper;
+    }
+
+    return result;
+}
@@ -0,0 +1,97 @@
+#ifndef SYMMETRIC_H
+#define SYMMETRIC_H
+
+#include "core.hpp"
+#include "caching/factorials.hpp"
+#include "inputs/relation.hpp"
+#include "inputs/params.hpp"
+#include "caching/outputs.hpp"
+#include "fast_sum/anytime.hpp"
+
+#include <unordered_map>
+
+struct AnytimeResult {
+    LikelihoodInterval log_likelihood;
+    size_t n_terms; // Number of terms evaluated
+    bool complete; // If every bin reached the requested precision
+};
+
+/* A DetectorRelation together with its flip, so that each bin is evaluated in whichever detector order is fastest.
+Counts are always given in the original detector order.
+
+Outputs are cached here in the original detector order, rather than in each DetectorRelation,
+so both orders share one cache. */
+class SymmetricRelation {
+    RelationParams params; // As given to the constructor
+    bool swapped; // If params are for the detectors in the opposite order
+
+    DetectorRelation forward;
+    DetectorRelation flipped;
+
+    /* Caches of calculated likelihoods, likelihood ratios, and completed anytime_log_likelihood results for single bins */
+    std::unordered_map<likelihood_args, scalar, hash_args> previous_outputs;
+    std::unordered_map<likelihood_args, scalar, hash_args> previous_ratios;
+    std::unordered_map<likelihood_args, LikelihoodInterval, hash_args> previous_intervals;
+
+public:
+    /* Same parameters as the DetectorRelation constructor */
+    SymmetricRelation(scalar bin_background_rate_1, scalar bin_background_rate_2, scalar sensitivity_ratio_2_to_1, scalar source_suppression);
+
+    SymmetricRelation(RelationParams params);
+
+    /* If swapped, the relation for the detectors in the opposite order to params. This is built by flipping the relation
+    for params, rather than from params.flipped(), so it evaluates exactly as the relation for params does with counts swapped. */
+    SymmetricRelation(RelationParams params, bool swapped);
+
+    /* Identical detectors with 0 background, as for DetectorRelation. Included to provide a default constructor to Cython. */
+    SymmetricRelation();
+
+    /* Parameters this relation was constructed from, in its detector order (with a reciprocal ratio if swapped) */
+    RelationParams parameters() const { return swapped ? params.flipped() : params; }
+
+    /* Parameters for the detectors in the opposite order, exactly as given to the constructor if swapped */
+    RelationParams flipped_parameters() const { return swapped ? params : params.flipped(); }
+
+    /* Approximate memory used by this relation, including its output caches, in bytes */
+    size_t cache_memory() const;
+
+    /* See DetectorRelation::bin_log_likelihood. The order of counts does not matter to speed.
+    use_cache specifies whether to use the output cache - that remembers previous inputs and their outputs. */
+    scalar bin_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2, scalar rel_precision, bool use_cache);
+
+    /* Write the log-likelihood of each of n_bins pairs of counts into out, which must have space for n_bins values. */
+    void bin_log_likelihoods(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, bool use_cache, scalar* out);
+
+    /* Total log-likelihood of a pair of histograms with n_bins bins each. */
+    scalar log_likelihood(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, bool use_cache);
+
+    /* See DetectorRelation::bin_background_log_likelihood */
+    scalar bin_background_log_likelihood(FactorialCache& fcache, size_t count_1, size_t count_2) const;
+
+    /* Returns bin_log_likelihood - bin_background_log_likelihood, the log of the ratio between the likelihoods of a
+    coincident burst and of background only. Arguments are as for bin_log_likelihood, and use_cache also determines
+    whether to use a separate cache of previous ratios. */
+    scalar bin_log_likelihood_ratio(FactorialCache& fcache, size_t count_1, size_t count_2, scalar rel_precision, bool use_cache);
+
+    /* Write the log-likelihood ratio of each of n_bins pairs of counts into out, which must have space for n_bins values. */
+    void bin_log_likelihood_ratios(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, bool use_cache, scalar* out);
+
+    /* Total log-likelihood ratio of a pair of histograms with n_bins bins each.
+    Both hypotheses are evaluated together, in a single pass over the bins. */
+    scalar log_likelihood_ratio(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, bool use_cache);
+
+    /* Total log-likelihood of a pair of histograms, evaluated within a budget, with rigorous bounds.
+
+    Stops when every bin reaches rel_precision, or after time_limit seconds (infinity for no limit),
+    or after approximately max_terms terms in total (SIZE_MAX for no limit), whichever is first.
+    Bins with the same counts are evaluated once. Every bin first gets closed form bounds (see BinSumTerms::log_likelihood_bounds),
+    so the bounds are always finite. The budget is then shared between bins in small steps, each time continuing the bin with the
+    largest remaining uncertainty (weighted by the number of bins with those counts). Factorials needed to start a bin are
+    built in steps too, so very large counts cannot overrun the time limit.
+
+    use_cache specifies whether to use a cache of bins previously completed by this function (separate from other caches).
+    */
+    AnytimeResult anytime_log_likelihood(FactorialCache& fcache, size_t const* counts_1, size_t const* counts_2, size_t n_bins, scalar rel_precision, scalar time_limit, size_t max_terms, bool use_cache);
+};
+
+#endif
@@ -0,0 +1,212 @@
+#include "search/lag_search.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    /* Division rounding towards negative infinity */
+    lag_t floor_div(lag_t numerator, lag_t denominator) {
+        lag_t quotient = numerator / denominator;
+        return (numerator % denominator != 0 && numerator < 0) ? quotient - 1 : quotient;
+    }
+
+    vec background_prefix(FactorialCache& fcache, std::vector<size_t> const& counts, scalar bin_background_rate) {
+        vec prefix(counts.size() + 1);
+        prefix[0] = 0;
+
+        for (size_t i = 0; i < counts.size(); i++) {
+            fcache.build_upto(counts[i]);
+            prefix[i + 1] = prefix[i] + fcache.log_poisson(bin_background_rate, counts[i]);
+        }
+
+        return prefix;
+    }
+
+    std::vector<size_t> rebin_pairs(std::vector<size_t> const& counts) {
+        std::vector<size_t> rebinned(counts.size() / 2);
+        for (size_t i = 0; i < rebinned.size(); i++) {
+            rebinned[i] = counts[2 * i] + counts[2 * i + 1];
+        }
+        return rebinned;
+    }
+}
+
+LagSearch::LagSearch(SymmetricRelation& relation, size_t const* counts_1, size_t n_bins_1, size_t const* counts_2, size_t n_bins_2, size_t n_levels, bool swapped) :
+    relation(relation),
+    swapped(swapped),
+    params(swapped ? relation.flipped_parameters() : relation.parameters())
+{
+    if (n_levels == 0) throw std::invalid_argument("At least one level is required");
+
+    levels.push_back({ 1, { counts_1, counts_1 + n_bins_1 }, { counts_2, counts_2 + n_bins_2 }, {}, {}, {}, {} });
+
+    while (levels.size() < n_levels) {
+        Level const& finer = levels.back();
+        size_t bin_factor = 2 * finer.bin_factor;
+
+        std::vector<size_t> coarse_1 = rebin_pairs(finer.counts_1);
+        std::vector<size_t> coarse_2 = rebin_pairs(finer.counts_2);
+        if (coarse_1.empty() || coarse_2.empty()) break;
+
+        SymmetricRelation coarse_relation(params.rebinned(bin_factor));
+        levels.push_back({ bin_factor, std::move(coarse_1), std::move(coarse_2), std::move(coarse_relation), {}, {}, {} });
+    }
+}
+
+SymmetricRelation& LagSearch::level_relation(size_t level_i) {
+    return (level_i == 0) ? relation : levels[level_i].coarse_relation;
+}
+
+std::pair<lag_t, lag_t> LagSearch::level_lag_range(size_t level_i, lag_t min_lag, lag_t max_lag) const {
+    lag_t factor = levels[level_i].bin_factor;
+    return { floor_div(min_lag, factor), floor_div(max_lag, factor) };
+}
+
+std::pair<lag_t, lag_t> LagSearch::level_window(size_t level_i, std::pair<lag_t, lag_t> lag_range) const {
+    Level const& level = levels[level_i];
+    lag_t n_bins_1 = level.counts_1.size();
+    lag_t n_bins_2 = level.counts_2.size();
+
+    return { std::max<lag_t>(0, -lag_range.first), std::min(n_bins_1, n_bins_2 - lag_range.second) };
+}
+
+void LagSearch::prepare_background(FactorialCache& fcache, size_t level_i) {
+    Level& level = levels[level_i];
+    if (!level.background_prefix_1.empty()) return;
+
+    RelationParams level_params = params.rebinned(level.bin_factor);
+    level.background_prefix_1 = background_prefix(fcache, level.counts_1, level_params.bin_background_rate_1);
+    level.background_prefix_2 = background_prefix(fcache, level.counts_2, level_params.bin_background_rate_2);
+}
+
+scalar LagSearch::window_statistic(FactorialCache& fcache, size_t level_i, std::pair<lag_t, lag_t> window, lag_t lag, scalar rel_precision, bool use_cache, bool likelihood_ratio) {
+    Level& level = levels[level_i];
+    auto [first, last] = window;
+
+    size_t const* window_1 = level.counts_1.data() + first;
+    size_t const* window_2 = level.counts_2.data() + first + lag;
+    if (level_i == 0 && swapped) std::swap(window_1, window_2);
+
+    scalar result = level_relation(level_i).log_likelihood(fcache, window_1, window_2, last - first, rel_precision, use_cache);
+
+    if (likelihood_ratio) {
+        prepare_background(fcache, level_i);
+        result -= level.background_prefix_1[last] - level.background_prefix_1[first];
+        result -= level.background_prefix_2[last + lag] - level.background_prefix_2[first + lag];
+    }
+
+    return result;
+}
+
+scalar LagSearch::evaluate(FactorialCache& fcache, size_t level_i, std::pair<lag_t, lag_t> window, lag_t lag, scalar rel_precision, bool likelihood_ratio, size_t& n_bin_evaluations) {
+    Level& level = levels[level_i];
+
+    if (auto found = level.evaluated.find(lag); found != level.evaluated.end()) return found->second;
+
+    scalar result = window_statistic(fcache, level_i, window, lag, rel_precision, true, likelihood_ratio);
+    n_bin_evaluations += window.second - window.first;
+
+    level.evaluated[lag] = result;
+    return result;
+}
+
+vec LagSearch::scan(FactorialCache& fcache, lag_t min_lag, lag_t max_lag, scalar rel_precision, bool use_cache, bool likelihood_ratio) {
+    if (min_lag > max_lag) throw std::invalid_argument("Empty lag range");
+
+    auto window = level_window(0, { min_lag, max_lag });
+    if (window.first >= window.second) throw std::invalid_argument("No bins can be paired at every lag in range");
+
+    vec results(max_lag - min_lag + 1);
+
+    for (lag_t lag = min_lag; lag <= max_lag; lag++) {
+        results[lag - min_lag] = window_statistic(fcache, 0, window, lag, rel_precision, use_cache, likelihood_ratio);
+    }
+
+    return results;
+}
+
+LagSearchResult LagSearch::search(FactorialCache& fcache, lag_t min_lag, lag_t max_lag, scalar rel_precision, size_t beam_width, size_t curve_radius, bool likelihood_ratio) {
+    if (min_lag > max_lag) throw std::invalid_argument("Empty lag range");
+    if (beam_width == 0) throw std::invalid_argument("Beam width must be at least 1");
+
+    for (Level& level : levels) level.evaluated.clear();
+
+    if (auto [first, last] = level_window(0, { min_lag, max_lag }); first >= last) {
+        throw std::invalid_argument("No bins can be paired at every lag in range");
+    }
+
+    size_t top_level = levels.size() - 1;
+    while (top_level > 0) {
+        auto [first, last] = level_window(top_level, level_lag_range(top_level, min_lag, max_lag));
+        if (first < last) break;
+        top_level--;
+    }
+
+    size_t n_bin_evaluations = 0;
+
+    // Every lag at the top level is a candidate
+    auto [top_min, top_max] = level_lag_range(top_level, min_lag, max_lag);
+    std::vector<lag_t> candidates;
+    for (lag_t lag = top_min; lag <= top_max; lag++) candidates.push_back(lag);
+
+    for (size_t level_i = top_level; level_i > 0; level_i--) {
+        auto lag_range = level_lag_range(level_i, min_lag, max_lag);
+        auto window = level_window(level_i, lag_range);
+
+        std::vector<std::pair<scalar, lag_t>> ranked;
+        for (lag_t lag : candidates) {
+            ranked.push_back({ evaluate(fcache, level_i, window, lag, rel_precision, likelihood_ratio, n_bin_evaluations), lag });
+        }
+
+        size_t n_kept = std::min(beam_width, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + n_kept, ranked.end(), [](auto const& a, auto const& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        });
+
+        // Each lag covers the lags either side of twice its value at the next level
+        auto [finer_min, finer_max] = level_lag_range(level_i - 1, min_lag, max_lag);
+        candidates.clear();
+        for (size_t i = 0; i < n_kept; i++) {
+            lag_t centre = 2 * ranked[i].second;
+            for (lag_t lag = std::max(centre - 1, finer_min); lag <= std::min(centre + 1, finer_max); lag++) {
+                candidates.push_back(lag);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+    auto window = level_window(0, { min_lag, max_lag });
+    LagSearchResult result { candidates.front(), 0, {}, {}, 0 };
+    result.best_log_likelihood = evaluate(fcache, 0, window, result.best_lag, rel_precision, likelihood_ratio, n_bin_evaluations);
+
+    for (lag_t lag : candidates) {
+        scalar value = evaluate(fcache, 0, window, lag, rel_precision, likelihood_ratio, n_bin_evaluations);
+        if (value > result.best_log_likelihood) result = { lag, value, {}, {}, 0 };
+    }
+
+    // Fill in the curve, moving to any better lag it finds, so the result is at least a local maximum
+    for (bool moved = true; moved;) {
+        moved = false;
+        result.curve_lags.clear();
+        result.curve_log_likelihoods.clear();
+
+        lag_t radius = curve_radius;
+        for (lag_t lag = std::max(result.best_lag - radius, min_lag); lag <= std::min(result.best_lag + radius, max_lag); lag++) {
+            scalar value = evaluate(fcache, 0, window, lag, rel_precision, likelihood_ratio, n_bin_evaluations);
+
+            if (value > result.best_log_likelihood) {
+                result.best_lag = lag;
+                result.best_log_likelihood = value;
+                moved = true;
+            }
+
+            result.curve_lags.push_back(lag);
+            result.curve_log_likelihoods.push_back(value);
+        }
+    }
+
+    result.n_bin_evaluations = n_bin_evaluations;
+    return result;
+}
@@ -0,0 +1,101 @@
+#ifndef LAG_SEARCH_H
+#define LAG_SEARCH_H
+
+#include "core.hpp"
+#include "caching/factorials.hpp"
+#include "inputs/symmetric.hpp"
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+/* Signed offset between histograms, in bins */
+typedef std::ptrdiff_t lag_t;
+
+struct LagSearchResult {
+    lag_t best_lag;
+    scalar best_log_likelihood; // Or log-likelihood ratio, if requested
+
+    /* Consecutive lags around best_lag (ascending), and their log-likelihoods */
+    std::vector<lag_t> curve_lags;
+    vec curve_log_likelihoods;
+
+    /* Number of bin log-likelihoods requested (whether or not they were cached) */
+    size_t n_bin_evaluations;
+};
+
+/* Finds the time offset between the histograms at two detectors which maximises their log-likelihood,
+or their log-likelihood ratio against background only.
+
+At lag L, bin i at detector 1 is paired with bin i + L at detector 2.
+For a range of lags, only the bins at detector 1 that can be paired at every lag in the range are included,
+so all lags are compared over the same number of bins.
+
+Histograms are also stored rebinned into a pyramid of levels, with level k summing 2^k adjacent bins,
+so that the search can start at low resolution and refine only around the most likely lags. */
+class LagSearch {
+    /* One level of the pyramid */
+    struct Level {
+        size_t bin_factor;
+        std::vector<size_t> counts_1;
+        std::vector<size_t> counts_2;
+
+        SymmetricRelation coarse_relation; // Unused at level 0, where the original relation is used instead
+
+        /* Cumulative background-only log-likelihoods, so that the total over any range of bins takes two lookups.
+        Element i is the total over bins [0, i). Empty until first needed. */
+        vec background_prefix_1;
+        vec background_prefix_2;
+
+        std::map<lag_t, scalar> evaluated; // Memo of log-likelihoods for the current search
+    };
+
+    SymmetricRelation& relation;
+    bool swapped; // If the relation's detectors are in the opposite order to the histograms
+    RelationParams params; // In the order of the histograms
+
+    std::vector<Level> levels;
+
+    SymmetricRelation& level_relation(size_t level_i);
+
+    /* Lags [first, last] at this level covering [min_lag, max_lag] at full resolution */
+    std::pair<lag_t, lag_t> level_lag_range(size_t level_i, lag_t min_lag, lag_t max_lag) const;
+
+    /* Bins at detector 1, [first, last), that can be paired at every lag in the range. Empty if first >= last. */
+    std::pair<lag_t, lag_t> level_window(size_t level_i, std::pair<lag_t, lag_t> lag_range) const;
+
+    /* Fill in the level's background_prefix arrays, if not already */
+    void prepare_background(FactorialCache& fcache, size_t level_i);
+
+    /* Log-likelihood (ratio) of bins [first, last) at detector 1 with the bins at detector 2 offset by lag */
+    scalar window_statistic(FactorialCache& fcache, size_t level_i, std::pair<lag_t, lag_t> window, lag_t lag, scalar rel_precision, bool use_cache, bool likelihood_ratio);
+
+    /* window_statistic, memoised for the current search */
+    scalar evaluate(FactorialCache& fcache, size_t level_i, std::pair<lag_t, lag_t> window, lag_t lag, scalar rel_precision, bool likelihood_ratio, size_t& n_bin_evaluations);
+
+public:
+    /* relation - Detectors the histograms are from, used directly for full resolution evaluation (including its output cache).
+        Relations for coarser levels are constructed from its rebinned parameters.
+    counts_1/2 - Histograms at detector 1/2, copied. These may have different numbers of bins.
+    n_levels - Maximum number of pyramid levels, including full resolution. Incomplete bins at the end of each histogram are
+        dropped at coarse levels, and levels with no bins are not built.
+    swapped - If set, counts_1 are from the relation's detector 2 and counts_2 from its detector 1,
+        so that a relation shared between both orders (see RelationRegistry) can be used with its cache.
+    */
+    LagSearch(SymmetricRelation& relation, size_t const* counts_1, size_t n_bins_1, size_t const* counts_2, size_t n_bins_2, size_t n_levels, bool swapped);
+
+    /* Log-likelihood for every lag in [min_lag, max_lag], at full resolution.
+    If likelihood_ratio is set, the log-likelihood ratio against background only (see SymmetricRelation::bin_log_likelihood_ratio)
+    is returned instead. The background-only term of each bin is calculated once, not once per lag. */
+    vec scan(FactorialCache& fcache, lag_t min_lag, lag_t max_lag, scalar rel_precision, bool use_cache, bool likelihood_ratio);
+
+    /* Coarse-to-fine search for the lag in [min_lag, max_lag] with the highest log-likelihood.
+    Every lag is evaluated at the coarsest level with bins to pair, then at each finer level only the lags
+    around the beam_width best lags from the level above are evaluated.
+    The returned curve covers curve_radius lags either side of the best lag (where in range).
+    likelihood_ratio is as for scan, and full resolution values are identical to those from scan.
+    */
+    LagSearchResult search(FactorialCache& fcache, lag_t min_lag, lag_t max_lag, scalar rel_precision, size_t beam_width, size_t curve_radius, bool likelihood_ratio);
+};
+
+#endif
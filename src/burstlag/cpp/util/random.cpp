@@ -0,0 +1,49 @@
+#include "util/random.hpp"
+
+namespace {
+    constexpr std::uint32_t PHILOX_M0 = 0xD2511F53;
+    constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+    constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9;
+    constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85;
+
+    constexpr size_t PHILOX_ROUNDS = 10;
+
+    inline std::uint32_t high_word(std::uint64_t x) { return x >> 32; }
+    inline std::uint32_t low_word(std::uint64_t x) { return static_cast<std::uint32_t>(x); }
+}
+
+CounterRNG::CounterRNG(std::uint64_t seed, std::uint64_t stream) :
+    key { low_word(seed), high_word(seed) }, stream(stream), position(0), block {}, n_used(block.size())
+{}
+
+void CounterRNG::refill() {
+    std::array<std::uint32_t, 4> ctr { low_word(position), high_word(position), low_word(stream), high_word(stream) };
+    std::array<std::uint32_t, 2> round_key = key;
+
+    for (size_t round = 0; round < PHILOX_ROUNDS; round++) {
+        std::uint64_t product_0 = static_cast<std::uint64_t>(PHILOX_M0) * ctr[0];
+        std::uint64_t product_1 = static_cast<std::uint64_t>(PHILOX_M1) * ctr[2];
+
+        ctr = {
+            high_word(product_1) ^ ctr[1] ^ round_key[0], low_word(product_1),
+            high_word(product_0) ^ ctr[3] ^ round_key[1], low_word(product_0)
+        };
+
+        round_key[0] += PHILOX_W0;
+        round_key[1] += PHILOX_W1;
+    }
+
+    block = ctr;
+    n_used = 0;
+    position++;
+}
+
+std::uint32_t CounterRNG::next_u32() {
+    if (n_used == block.size()) refill();
+    return block[n_used++];
+}
+
+scalar CounterRNG::next_uniform() {
+    std::uint64_t bits = (static_cast<std::uint64_t>(next_u32()) << 32) | next_u32();
+    return (bits >> 11) * 0x1.0p-53;
+}
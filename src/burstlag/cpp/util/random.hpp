@@ -0,0 +1,33 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "core.hpp"
+
+#include <array>
+#include <cstdint>
+
+/* Counter-based random number generator (Philox4x32-10).
+Each (seed, stream, position) maps directly to a block of random bits, so independent streams can be created
+for any index without generating or skipping over earlier values. This makes results reproducible however work is
+divided between threads. */
+class CounterRNG {
+    std::array<std::uint32_t, 2> key;
+    std::uint64_t stream;
+    std::uint64_t position;
+
+    std::array<std::uint32_t, 4> block;
+    size_t n_used;
+
+    /* Generate the block for the current position */
+    void refill();
+
+public:
+    CounterRNG(std::uint64_t seed, std::uint64_t stream);
+
+    std::uint32_t next_u32();
+
+    /* Uniformly distributed in [0, 1), with 53 random bits */
+    scalar next_uniform();
+};
+
+#endif
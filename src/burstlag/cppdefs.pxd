@@ -1,27 +1,141 @@
 # This is the cython equivalent of a header file, which exposes the c++ classes to the cython code
 
 from libcpp.vector cimport vector
+from libc.stdint cimport uint32_t, uint64_t
+from libcpp.string cimport string
+from libcpp.memory cimport shared_ptr
+from libc.stddef cimport ptrdiff_t
 
 cdef extern from "caching/factorials.hpp":
     cdef cppclass FactorialCache:
         FactorialCache() except +
 
-cdef extern from "inputs/relation.hpp":
-    cdef cppclass DetectorRelation:
-        DetectorRelation() except +
+cdef extern from "fast_sum/anytime.hpp":
+    cdef cppclass LikelihoodInterval:
+        double estimate
+        double lower
+        double upper
 
-        DetectorRelation(
+cdef extern from "inputs/symmetric.hpp":
+    cdef cppclass AnytimeResult:
+        LikelihoodInterval log_likelihood
+        size_t n_terms
+        bint complete
+
+    cdef cppclass SymmetricRelation:
+        SymmetricRelation() except +
+
+        SymmetricRelation(
             double bin_background_rate_1,
             double bin_background_rate_2,
             double sensitivity_ratio_2_to_1,
             double source_suppression
         ) except +
 
-        DetectorRelation flip() except +
-
         double bin_log_likelihood(
             FactorialCache& fcache,
             size_t count_1, size_t count_2,
             double rel_precision,
             bint use_cache
-        ) except +
\ No newline at end of file
+        ) except +
+
+        double bin_log_likelihood_ratio(
+            FactorialCache& fcache,
+            size_t count_1, size_t count_2,
+            double rel_precision,
+            bint use_cache
+        ) except +
+
+        AnytimeResult anytime_log_likelihood(
+            FactorialCache& fcache,
+            const size_t* counts_1, const size_t* counts_2, size_t n_bins,
+            double rel_precision,
+            double time_limit,
+            size_t max_terms,
+            bint use_cache
+        ) except +
+
+cdef extern from "inputs/params.hpp":
+    cdef cppclass RelationParams:
+        double bin_background_rate_1
+        double bin_background_rate_2
+        double sensitivity_ratio_2_to_1
+        double source_suppression
+
+cdef extern from "caching/registry.hpp":
+    cdef cppclass RegisteredRelation:
+        shared_ptr[SymmetricRelation] relation
+        bint flipped
+
+    cdef cppclass RelationRegistry:
+        RegisteredRelation get(RelationParams params) except +
+        void configure(double tolerance, size_t memory_budget) except +
+        void clear() except +
+        size_t size() except +
+        size_t memory_used() except +
+
+    RelationRegistry& global_relation_registry "RelationRegistry::global"() except +
+
+cdef extern from "calibration/background.hpp":
+    cdef cppclass BackgroundCalibration:
+        BackgroundCalibration(
+            const SymmetricRelation& relation,
+            double bin_background_rate_1,
+            double bin_background_rate_2
+        ) except +
+
+        void sample_distribution(
+            size_t n_samples, size_t n_bins,
+            double rel_precision,
+            uint64_t seed,
+            size_t n_threads,
+            double* out
+        ) except + nogil
+
+cdef extern from "search/lag_search.hpp":
+    ctypedef ptrdiff_t lag_t
+
+    cdef cppclass LagSearchResult:
+        lag_t best_lag
+        double best_log_likelihood
+        vector[lag_t] curve_lags
+        vector[double] curve_log_likelihoods
+        size_t n_bin_evaluations
+
+    cdef cppclass LagSearch:
+        LagSearch(
+            SymmetricRelation& relation,
+            const size_t* counts_1, size_t n_bins_1,
+            const size_t* counts_2, size_t n_bins_2,
+            size_t n_levels,
+            bint swapped
+        ) except +
+
+        vector[double] scan(
+            FactorialCache& fcache,
+            lag_t min_lag, lag_t max_lag,
+            double rel_precision,
+            bint use_cache,
+            bint likelihood_ratio
+        ) except +
+
+        LagSearchResult search(
+            FactorialCache& fcache,
+            lag_t min_lag, lag_t max_lag,
+            double rel_precision,
+            size_t beam_width,
+            size_t curve_radius,
+            bint likelihood_ratio
+        ) except +
+
+cdef extern from "archive/format.hpp":
+    ctypedef uint32_t archive_count
+
+    void write_archive(
+        const string& path,
+        const archive_count** counts,
+        size_t n_detectors,
+        size_t n_bins,
+        size_t chunk_bins,
+        double bin_width
+    ) except +
\ No newline at end of file
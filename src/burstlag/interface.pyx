@@ -6,13 +6,21 @@
 cimport cython
 
 from libcpp.vector cimport vector
+from libc.stdint cimport uint64_t
+from libcpp.string cimport string
+from libcpp.memory cimport shared_ptr
+from cython.operator cimport dereference as deref
 
 import logging
+import os
 import numpy as np
 from sys import float_info
 from functools import lru_cache
+from collections import namedtuple
 
-from .cppdefs cimport DetectorRelation as CPPDetectorRelation, FactorialCache as CPPFactorialCache
+from .cppdefs cimport SymmetricRelation as CPPSymmetricRelation, AnytimeResult as CPPAnytimeResult, FactorialCache as CPPFactorialCache, BackgroundCalibration as CPPBackgroundCalibration, LagSearch as CPPLagSearch, LagSearchResult as CPPLagSearchResult, lag_t
+from .cppdefs cimport archive_count, write_archive as cpp_write_archive
+from .cppdefs cimport RelationParams as CPPRelationParams, RegisteredRelation as CPPRegisteredRelation, global_relation_registry
 
 cdef class FactorialCache:
     c_cache: CPPFactorialCache
@@ -29,12 +37,102 @@ cdef size_t convert_to_count(numeric_in n):
 
     return <size_t> n
 
+cdef vector[size_t] convert_to_counts(numeric_in[:] signal):
+    cdef vector[size_t] counts
+    counts.reserve(signal.shape[0])
+
+    cdef Py_ssize_t i
+    for i in range(signal.shape[0]):
+        counts.push_back(convert_to_count(signal[i]))
+
+    return counts
+
+LagSearchResult = namedtuple("LagSearchResult", ["best_lag", "best_log_likelihood", "lags", "log_likelihoods", "n_bin_evaluations"])
+LagSearchResult.__doc__ = """Result of DetectorRelation.lag_search.
+best_lag is the lag with the highest log-likelihood (or ratio, if requested) found, and best_log_likelihood its value.
+lags and log_likelihoods are arrays describing the likelihood curve around the peak.
+n_bin_evaluations is the number of bin log-likelihoods that were requested."""
+
+AnytimeLikelihood = namedtuple("AnytimeLikelihood", ["estimate", "lower", "upper", "complete", "n_terms"])
+AnytimeLikelihood.__doc__ = """Result of DetectorRelation.log_likelihood_anytime.
+The true log-likelihood lies in [lower, upper], and estimate is the best single value.
+complete is True if every bin reached the requested precision within the budget, and n_terms is the number of terms evaluated."""
+
+def write_archive(path, hists, size_t chunk_bins = 65536, double bin_width = 1.) -> None:
+    """Write histograms from any number of detectors to a binary archive, for replay with the native burstlag_replay tool.
+
+    The archive is a fixed-width format of 32-bit counts, in chunks of chunk_bins bins per detector, so it can be memory mapped.
+    See src/burstlag/cpp/archive/format.hpp for the layout.
+
+    :param path str: File to write (overwritten if it exists)
+    :param hists: Sequence of np.ndarray histograms, one per detector, all with the same number of bins
+    :param chunk_bins int: Bins per detector in each chunk
+    :param bin_width float: Width of the histogram bins, stored for reference
+
+    :raises IndexError: If histograms have different numbers of bins.
+    :raises ValueError: If any count is negative or too large for 32 bits, or there are no histograms.
+    """
+
+    arrays = [np.asarray(hist) for hist in hists]
+    if not arrays:
+        raise ValueError("No histograms to write")
+
+    cdef Py_ssize_t n_bins = len(arrays[0])
+    for array in arrays:
+        if len(array) != n_bins:
+            raise IndexError(f"Histograms have different numbers of bins {n_bins}, {len(array)}")
+        if n_bins > 0 and (np.min(array) < 0 or np.max(array) > np.iinfo(np.uint32).max):
+            raise ValueError("Counts must be non-negative and fit in 32 bits")
+
+    counts = [np.ascontiguousarray(array, dtype=np.uint32) for array in arrays]
+
+    cdef vector[const archive_count*] pointers
+    cdef archive_count[::1] view
+    for array in counts:
+        view = array
+        pointers.push_back(&view[0] if n_bins > 0 else NULL)
+
+    cpp_write_archive(os.fsencode(path), pointers.data(), pointers.size(), <size_t> n_bins, chunk_bins, bin_width)
+
+RelationRegistryStats = namedtuple("RelationRegistryStats", ["n_relations", "memory_used"])
+RelationRegistryStats.__doc__ = """Result of relation_registry_stats.
+n_relations is the number of relations held, and memory_used the approximate memory in bytes used by the caches of those not in use."""
+
+def configure_relation_registry(double tolerance = 0., size_t memory_budget = 256 << 20) -> None:
+    """Configure the process-wide registry through which DetectorRelation instances with equivalent parameters share their caches.
+
+    :param tolerance float: Relative tolerance for parameters to be equivalent. Parameters are quantised in steps of this relative size,
+        and relations are constructed from the quantised values, so results may change by about as much as a relative change of tolerance / 2 in the parameters would.
+        With 0 (the default), only identical parameters (or the same parameters with detectors swapped) are equivalent, and results are unchanged.
+    :param memory_budget int: Approximate memory in bytes to keep for the caches of relations no longer in use. The least recently used are dropped first.
+
+    Changing the tolerance drops all relations not in use.
+
+    :raises ValueError: If tolerance is negative or not finite.
+    """
+
+    global_relation_registry().configure(tolerance, memory_budget)
+
+def clear_relation_registry() -> None:
+    """Drop all relations held by the registry, so new DetectorRelation instances start with empty caches. Existing instances are unaffected."""
+
+    global_relation_registry().clear()
+
+def relation_registry_stats() -> RelationRegistryStats:
+    """Current size of the relation registry, see RelationRegistryStats."""
+
+    return RelationRegistryStats(global_relation_registry().size(), global_relation_registry().memory_used())
+
 cdef class DetectorRelation:
     """ Stores the relative parameters describing two neutrino detectors providing data to SNEWS.
-    Implements methods to calculate likelihoods of coincident neutrino bursts. """
+    Implements methods to calculate likelihoods of coincident neutrino bursts.
 
-    c_rel: CPPDetectorRelation
-    c_rel_flipped: CPPDetectorRelation
+    Instances with equivalent parameters share one underlying relation and its caches (see configure_relation_registry),
+    so recreating a relation, e.g. with from_counts for each new window, keeps previous outputs. """
+
+    # Shared relation from the registry, with detectors in the opposite order to this instance's if flipped
+    cdef shared_ptr[CPPSymmetricRelation] c_rel
+    cdef bint flipped
 
     bin_background_rate_1: float
     bin_background_rate_2: float
@@ -54,8 +152,15 @@ cdef class DetectorRelation:
         self._sensitivity_ratio_2_to_1 = sensitivity_ratio_2_to_1
         self._source_suppression = source_suppression
 
-        self.c_rel = CPPDetectorRelation(bin_background_rate_1, bin_background_rate_2, sensitivity_ratio_2_to_1, source_suppression)
-        self.c_rel_flipped = self.c_rel.flip()
+        cdef CPPRelationParams params
+        params.bin_background_rate_1 = bin_background_rate_1
+        params.bin_background_rate_2 = bin_background_rate_2
+        params.sensitivity_ratio_2_to_1 = sensitivity_ratio_2_to_1
+        params.source_suppression = source_suppression
+
+        cdef CPPRegisteredRelation registered = global_relation_registry().get(params)
+        self.c_rel = registered.relation
+        self.flipped = registered.flipped
 
     def __repr__(self: DetectorRelation):
         return f"DetectorRelation({self.bin_background_rate_1}, {self.bin_background_rate_2}, {self._sensitivity_ratio_2_to_1}, {self._source_suppression})"
@@ -115,11 +220,10 @@ cdef class DetectorRelation:
     cpdef double bin_log_likelihood(DetectorRelation self, FactorialCache cache, numeric_in count_1, numeric_in count_2, double rel_precision, bint use_cache = True):
         cdef size_t u_count_1 = convert_to_count(count_1)
         cdef size_t u_count_2 = convert_to_count(count_2)
+        if self.flipped:
+            u_count_1, u_count_2 = u_count_2, u_count_1
 
-        if u_count_1 > u_count_2:
-            return self.c_rel.bin_log_likelihood(cache.c_cache, u_count_1, u_count_2, rel_precision, use_cache)
-        else:
-            return self.c_rel_flipped.bin_log_likelihood(cache.c_cache, u_count_2, u_count_1, rel_precision, use_cache)
+        return deref(self.c_rel).bin_log_likelihood(cache.c_cache, u_count_1, u_count_2, rel_precision, use_cache)
 
     def log_likelihood(DetectorRelation self, FactorialCache cache, numeric_in[:] signal_1, numeric_in[:] signal_2, double rel_precision, bint use_cache = True) -> float:
         """Calculate the log-likelihood of detecting coincident neutrino counts at the two detectors.
@@ -155,4 +259,162 @@ cdef class DetectorRelation:
         except RuntimeError:
             logging.warning(f"Divergent sum term for counts: ({signal_1[i]}, {signal_2[i]}) at precision {rel_precision},\ndetector = {self}")
 
-        return likelihood
\ No newline at end of file
+        return likelihood
+
+    def log_likelihood_anytime(DetectorRelation self, FactorialCache cache, numeric_in[:] signal_1, numeric_in[:] signal_2, double rel_precision, time_limit: float = None, max_terms: int = None, bint use_cache = True) -> AnytimeLikelihood:
+        """Calculate the log-likelihood as for log_likelihood, but within a time or work budget, with rigorous error bounds.
+
+        The largest terms of each bin's sum are evaluated first, and the budget is shared between bins, always continuing the bin with the largest remaining uncertainty.
+        If the budget runs out, the current estimate is returned, with bounds allowing for all terms not yet evaluated (and the approximate exponential used).
+
+        :param time_limit float: Maximum time in seconds (approximately), or None for no limit
+        :param max_terms int: Maximum number of terms to evaluate (approximately), or None for no limit
+        :param use_cache bool: Whether to use a cache of bins previously completed by this method (separate from the log_likelihood cache)
+        Other parameters are as for log_likelihood.
+
+        :return AnytimeLikelihood: The estimate and bounds. The bounds are always finite: bins not started within the budget use looser closed form bounds.
+
+        :raises IndexError: If signal arrays are of different size.
+        """
+
+        cdef Py_ssize_t n_bins = signal_1.shape[0]
+        cdef Py_ssize_t n_bins_2 = signal_2.shape[0]
+        if n_bins != n_bins_2:
+            raise IndexError(f"Signals have different numbers of bins {n_bins}, {n_bins_2}")
+
+        cdef vector[size_t] counts_1 = convert_to_counts(signal_1)
+        cdef vector[size_t] counts_2 = convert_to_counts(signal_2)
+
+        cdef double c_time_limit = float("inf") if time_limit is None else time_limit
+        cdef size_t c_max_terms = <size_t> -1 if max_terms is None else max_terms
+
+        if self.flipped:
+            counts_1.swap(counts_2)
+
+        cdef CPPAnytimeResult result = deref(self.c_rel).anytime_log_likelihood(cache.c_cache, counts_1.data(), counts_2.data(), n_bins, rel_precision, c_time_limit, c_max_terms, use_cache)
+
+        return AnytimeLikelihood(result.log_likelihood.estimate, result.log_likelihood.lower, result.log_likelihood.upper, result.complete, result.n_terms)
+
+    cpdef double bin_log_likelihood_ratio(DetectorRelation self, FactorialCache cache, numeric_in count_1, numeric_in count_2, double rel_precision, bint use_cache = True):
+        cdef size_t u_count_1 = convert_to_count(count_1)
+        cdef size_t u_count_2 = convert_to_count(count_2)
+        if self.flipped:
+            u_count_1, u_count_2 = u_count_2, u_count_1
+
+        return deref(self.c_rel).bin_log_likelihood_ratio(cache.c_cache, u_count_1, u_count_2, rel_precision, use_cache)
+
+    def log_likelihood_ratio(DetectorRelation self, FactorialCache cache, numeric_in[:] signal_1, numeric_in[:] signal_2, double rel_precision, bint use_cache = True) -> float:
+        """Calculate the log of the ratio between the likelihood of a coincident neutrino burst (as from log_likelihood),
+        and the likelihood of background only (independent Poisson counts at bin_background_rates).
+
+        Both hypotheses are evaluated in a single pass over the bins, and use_cache also determines whether to use a cache of previous ratios.
+        Parameters, exceptions and precision are otherwise as for log_likelihood (the background-only term is exact).
+
+        :return float: The total log-likelihood ratio, within specified precision.
+        """
+
+        cdef Py_ssize_t n_bins = signal_1.shape[0]
+        cdef Py_ssize_t n_bins_2 = signal_2.shape[0]
+        if n_bins != n_bins_2:
+            raise IndexError(f"Signals have different numbers of bins {n_bins}, {n_bins_2}")
+
+        cdef double ratio = 0
+        cdef Py_ssize_t i
+        try:
+            for i in range(n_bins):
+                ratio += self.bin_log_likelihood_ratio(cache, signal_1[i], signal_2[i], rel_precision, use_cache)
+        except RuntimeError:
+            logging.warning(f"Divergent sum term for counts: ({signal_1[i]}, {signal_2[i]}) at precision {rel_precision},\ndetector = {self}")
+
+        return ratio
+
+    def background_distribution(DetectorRelation self, size_t n_samples, size_t n_bins, double rel_precision, uint64_t seed = 0, size_t n_threads = 0) -> np.ndarray:
+        """Simulate background-only data, to find the distribution of log_likelihood in the absence of a burst.
+
+        :param n_samples int: Number of pairs of histograms to simulate
+        :param n_bins int: Number of bins in each histogram
+        :param rel_precision float: As for log_likelihood
+        :param seed int: Seed for the random number generator. The output depends only on this, not on n_threads.
+        :param n_threads int: Number of threads to evaluate with, 0 for one per core.
+
+        Counts are drawn from Poisson distributions with means bin_background_rates.
+        Each thread keeps its own cache of outputs, starting from this instance's (shared) cache, which is not modified.
+        The GIL is released during the calculation.
+
+        :return np.ndarray: The log-likelihoods of all samples, in ascending order. Quantiles can be found with np.quantile.
+
+        :raises RuntimeError: If any likelihood sum does not converge as expected (this generally indicates a bug).
+        """
+
+        distribution = np.empty(n_samples, dtype=np.float64)
+        if n_samples == 0:
+            return distribution
+
+        cdef double[::1] out = distribution
+        # Background rates in the order of the shared relation's detectors
+        cdef double rate_1 = self.bin_background_rate_2 if self.flipped else self.bin_background_rate_1
+        cdef double rate_2 = self.bin_background_rate_1 if self.flipped else self.bin_background_rate_2
+
+        cdef CPPBackgroundCalibration* calibration = new CPPBackgroundCalibration(deref(self.c_rel), rate_1, rate_2)
+        try:
+            with nogil:
+                calibration.sample_distribution(n_samples, n_bins, rel_precision, seed, n_threads, &out[0])
+        finally:
+            del calibration
+
+        return distribution
+
+    def lag_scan(DetectorRelation self, FactorialCache cache, numeric_in[:] signal_1, numeric_in[:] signal_2, lag_t min_lag, lag_t max_lag, double rel_precision, bint use_cache = True, bint likelihood_ratio = False) -> np.ndarray:
+        """Calculate the log-likelihood for every offset between the two histograms.
+
+        At lag L, bin i of signal_1 is paired with bin i + L of signal_2.
+        Only the bins of signal_1 that can be paired at every lag in range are included, so all lags are compared over the same number of bins.
+        Signals may have different numbers of bins.
+
+        :param min_lag int: First lag to evaluate
+        :param max_lag int: Last lag to evaluate (inclusive)
+        :param likelihood_ratio bool: Return log_likelihood_ratio values instead. The background-only term of each bin is calculated once, not per lag.
+        Other parameters are as for log_likelihood.
+
+        :return np.ndarray: Log-likelihood (ratio) at each lag from min_lag to max_lag.
+
+        :raises ValueError: If the lag range is empty, or no bins can be paired at every lag in range.
+        """
+
+        cdef vector[size_t] counts_1 = convert_to_counts(signal_1)
+        cdef vector[size_t] counts_2 = convert_to_counts(signal_2)
+
+        cdef CPPLagSearch* lag_search = new CPPLagSearch(deref(self.c_rel), counts_1.data(), counts_1.size(), counts_2.data(), counts_2.size(), 1, self.flipped)
+        try:
+            return np.array(lag_search.scan(cache.c_cache, min_lag, max_lag, rel_precision, use_cache, likelihood_ratio))
+        finally:
+            del lag_search
+
+    def lag_search(DetectorRelation self, FactorialCache cache, numeric_in[:] signal_1, numeric_in[:] signal_2, lag_t min_lag, lag_t max_lag, double rel_precision, size_t beam_width = 4, size_t n_levels = 8, size_t curve_radius = 3, bint likelihood_ratio = False) -> LagSearchResult:
+        """Find the offset between the two histograms with the highest log-likelihood, with far fewer evaluations than lag_scan.
+
+        Histograms are rebinned into a pyramid, each level summing pairs of bins from the level below, up to n_levels levels (including the original).
+        Every lag is evaluated at the coarsest level, then only lags around the beam_width best are evaluated at each finer level.
+        Background rates are rescaled for the wider bins at coarse levels.
+        Parameters (including likelihood_ratio) and lag conventions are otherwise as for lag_scan, and full resolution values match lag_scan exactly.
+
+        :param beam_width int: Number of lags refined at each level. Larger values make the search more robust to multiple peaks.
+        :param n_levels int: Maximum number of levels. Levels too coarse to pair any bins are skipped.
+        :param curve_radius int: Number of lags either side of the best to include in the returned curve.
+
+        :return LagSearchResult: The best lag found, its log-likelihood, and the curve around it.
+
+        :raises ValueError: If the lag range is empty, no bins can be paired at every lag in range, or beam_width or n_levels is 0.
+        """
+
+        cdef vector[size_t] counts_1 = convert_to_counts(signal_1)
+        cdef vector[size_t] counts_2 = convert_to_counts(signal_2)
+        cdef CPPLagSearchResult result
+
+        cdef CPPLagSearch* lag_search = new CPPLagSearch(deref(self.c_rel), counts_1.data(), counts_1.size(), counts_2.data(), counts_2.size(), n_levels, self.flipped)
+        try:
+            result = lag_search.search(cache.c_cache, min_lag, max_lag, rel_precision, beam_width, curve_radius, likelihood_ratio)
+        finally:
+            del lag_search
+
+        return LagSearchResult(result.best_lag, result.best_log_likelihood, np.array(result.curve_lags), np.array(result.curve_log_likelihoods), result.n_bin_evaluations)
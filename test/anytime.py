@@ -0,0 +1,64 @@
+import unittest
+import numpy as np
+
+from burstlag import FactorialCache, DetectorRelation
+
+class AnytimeTest(unittest.TestCase):
+    def setUp(self):
+        self.cache = FactorialCache()
+        self.rel = DetectorRelation(200., 0.5, 0.01)
+        self.sig_1 = np.array([1000, 400, 3, 210, 210], dtype=np.float64)
+        self.sig_2 = np.array([10, 5, 1, 0, 0], dtype=np.float64)
+
+    def test_complete(self):
+        precision = 1e-4
+
+        result = self.rel.log_likelihood_anytime(self.cache, self.sig_1, self.sig_2, precision)
+        exact = self.rel.log_likelihood(self.cache, self.sig_1, self.sig_2, 1e-9, False)
+
+        self.assertTrue(result.complete)
+        self.assertLessEqual(result.lower, exact)
+        self.assertLessEqual(exact, result.upper)
+        self.assertLessEqual(result.lower, result.estimate)
+        self.assertLessEqual(result.estimate, result.upper)
+        self.assertAlmostEqual(exact, result.estimate, delta=0.2)
+
+        # Completed bins are cached, so no terms are needed
+        self.assertEqual(0, self.rel.log_likelihood_anytime(self.cache, self.sig_1, self.sig_2, precision).n_terms)
+
+    def test_budget(self):
+        precision = 1e-4
+        exact = self.rel.log_likelihood(self.cache, self.sig_1, self.sig_2, 1e-9, False)
+
+        full = self.rel.log_likelihood_anytime(self.cache, self.sig_1, self.sig_2, precision, use_cache=False)
+        partial = self.rel.log_likelihood_anytime(self.cache, self.sig_1, self.sig_2, precision, max_terms=full.n_terms // 4, use_cache=False)
+
+        self.assertFalse(partial.complete)
+        self.assertLess(partial.n_terms, full.n_terms)
+        self.assertLessEqual(partial.lower, exact)
+        self.assertLessEqual(exact, partial.upper)
+        self.assertGreater(partial.upper - partial.lower, full.upper - full.lower)
+
+        # Nothing evaluated, so only the closed form bounds are known
+        empty = self.rel.log_likelihood_anytime(self.cache, self.sig_1, self.sig_2, precision, time_limit=0., use_cache=False)
+        self.assertFalse(empty.complete)
+        self.assertEqual(0, empty.n_terms)
+        self.assertLessEqual(empty.lower, exact)
+        self.assertLessEqual(exact, empty.upper)
+        self.assertLessEqual(empty.lower, empty.estimate)
+        self.assertLessEqual(empty.estimate, empty.upper)
+
+    def test_bright(self):
+        # Factorials for very large counts take far longer to build than the limit, so building them must be interrupted,
+        # leaving only the closed form bounds
+        sig_1 = np.array([20_000_000], dtype=np.float64)
+        sig_2 = np.array([200_000], dtype=np.float64)
+
+        result = self.rel.log_likelihood_anytime(FactorialCache(), sig_1, sig_2, 1e-4, time_limit=1e-4, use_cache=False)
+
+        self.assertFalse(result.complete)
+        self.assertEqual(0, result.n_terms)
+        self.assertTrue(np.isfinite(result.lower) and np.isfinite(result.upper) and np.isfinite(result.estimate))
+
+if __name__ == "__main__":
+    unittest.main()
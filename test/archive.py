@@ -0,0 +1,43 @@
+import os
+import tempfile
+import unittest
+import numpy as np
+
+from burstlag import write_archive
+
+class ArchiveTest(unittest.TestCase):
+    def test(self):
+        hist_1 = np.array([0, 1, 2, 3, 4, 5, 6], dtype=np.float64)
+        hist_2 = np.array([7, 0, 0, 1, 0, 2, 9], dtype=np.int64)
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "hists.bin")
+            write_archive(path, [hist_1, hist_2], chunk_bins=3, bin_width=0.5)
+
+            data = np.fromfile(path, dtype=np.uint8)
+
+        header, body = data[:64], data[64:].view("<u4")
+
+        self.assertEqual(b"BLAGHIST", header[:8].tobytes())
+        version, n_detectors = header[8:16].view("<u4")
+        chunk_bins, n_bins = header[16:32].view("<u8")
+        bin_width = header[32:40].view("<f8")[0]
+
+        self.assertEqual((1, 2, 3, 7, 0.5), (version, n_detectors, chunk_bins, n_bins, bin_width))
+
+        # 3 chunks, each of 3 bins per detector, last chunk zero-padded
+        chunks = body.reshape(3, 2, 3)
+        np.testing.assert_array_equal(hist_1, chunks[:, 0].ravel()[:7])
+        np.testing.assert_array_equal(hist_2, chunks[:, 1].ravel()[:7])
+        np.testing.assert_array_equal(0, chunks[2, :, 1:])
+
+    def test_invalid(self):
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "hists.bin")
+
+            self.assertRaises(IndexError, lambda: write_archive(path, [np.zeros(3), np.zeros(4)]))
+            self.assertRaises(ValueError, lambda: write_archive(path, [np.array([-1, 0])]))
+            self.assertRaises(ValueError, lambda: write_archive(path, []))
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,37 @@
+import unittest
+import numpy as np
+
+from burstlag import FactorialCache, DetectorRelation
+
+class CalibrationTest(unittest.TestCase):
+    def test(self):
+        precision = 1e-3
+        n_samples = 1000
+        n_bins = 5
+
+        rel = DetectorRelation(0.5, 3., 2.)
+
+        dist = rel.background_distribution(n_samples, n_bins, precision, seed=1, n_threads=1)
+
+        self.assertEqual(n_samples, len(dist))
+        self.assertTrue(np.all(np.diff(dist) >= 0))
+
+        # Reproducible, independent of threading
+        np.testing.assert_array_equal(dist, rel.background_distribution(n_samples, n_bins, precision, seed=1, n_threads=4))
+        self.assertFalse(np.array_equal(dist, rel.background_distribution(n_samples, n_bins, precision, seed=2)))
+
+        self.assertEqual(0, len(rel.background_distribution(0, n_bins, precision)))
+
+    def test_matches_log_likelihood(self):
+        precision = 1e-3
+
+        cache = FactorialCache()
+        rel = DetectorRelation(1e-9, 1e-9)
+        empty = np.zeros(4, dtype=np.float64)
+
+        # With negligible background, every sample is empty
+        dist = rel.background_distribution(10, 4, precision)
+        self.assertTrue(np.all(dist == rel.log_likelihood(cache, empty, empty, precision)))
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,52 @@
+import unittest
+import numpy as np
+
+from burstlag import FactorialCache, DetectorRelation
+
+class LagSearchTest(unittest.TestCase):
+    def setUp(self):
+        rng = np.random.default_rng(0)
+        n_bins = 512
+        true_lag = 37
+
+        burst = np.zeros(n_bins)
+        burst[200:230] = np.linspace(60, 0, 30)
+
+        self.true_lag = true_lag
+        self.hist_1 = rng.poisson(2. + burst).astype(np.float64)
+        self.hist_2 = rng.poisson(1. + 0.5 * np.roll(burst, true_lag)).astype(np.float64)
+
+        self.rel = DetectorRelation(2., 1., 0.5)
+
+    def test_matches_scan(self):
+        precision = 1e-3
+        min_lag, max_lag = -100, 100
+
+        cache = FactorialCache()
+        scan = self.rel.lag_scan(cache, self.hist_1, self.hist_2, min_lag, max_lag, precision)
+        self.assertEqual(max_lag - min_lag + 1, len(scan))
+
+        result = self.rel.lag_search(cache, self.hist_1, self.hist_2, min_lag, max_lag, precision)
+
+        self.assertEqual(self.true_lag, result.best_lag)
+        self.assertEqual(min_lag + np.argmax(scan), result.best_lag)
+        self.assertEqual(scan[result.best_lag - min_lag], result.best_log_likelihood)
+        np.testing.assert_array_equal(scan[result.lags - min_lag], result.log_likelihoods)
+        np.testing.assert_array_equal(np.arange(self.true_lag - 3, self.true_lag + 4), result.lags)
+
+        n_scan_evaluations = len(scan) * (len(self.hist_1) - (max_lag - min_lag))
+        self.assertLess(result.n_bin_evaluations, n_scan_evaluations / 4)
+
+    def test_single_level(self):
+        cache = FactorialCache()
+        result = self.rel.lag_search(cache, self.hist_1, self.hist_2, 30, 40, 1e-3, n_levels=1)
+        self.assertEqual(self.true_lag, result.best_lag)
+
+    def test_invalid(self):
+        cache = FactorialCache()
+        self.assertRaises(ValueError, lambda: self.rel.lag_scan(cache, self.hist_1, self.hist_2, 1, 0, 1e-3))
+        self.assertRaises(ValueError, lambda: self.rel.lag_search(cache, self.hist_1, self.hist_2, -600, 600, 1e-3))
+        self.assertRaises(ValueError, lambda: self.rel.lag_search(cache, self.hist_1, self.hist_2, 0, 1, 1e-3, beam_width=0))
+
+if __name__ == "__main__":
+    unittest.main()
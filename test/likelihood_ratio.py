@@ -0,0 +1,54 @@
+import unittest
+import numpy as np
+
+from math import log, lgamma
+
+from burstlag import FactorialCache, DetectorRelation
+
+def log_poisson(mean, n):
+    return n * log(mean) - mean - lgamma(n + 1)
+
+class LikelihoodRatioTest(unittest.TestCase):
+    def test(self):
+        precision = 1e-3
+
+        cache = FactorialCache()
+
+        a1 = np.array([0, 1, 2, 1, 0, 7], dtype=np.float64)
+        a2 = np.array([1, 2, 1, 0, 0, 3], dtype=np.float64)
+
+        rel = DetectorRelation(0.2, 0.3, 0.5)
+
+        for c1, c2 in zip(a1, a2):
+            expected = rel.bin_log_likelihood(cache, c1, c2, precision) - log_poisson(0.2, c1) - log_poisson(0.3, c2)
+            self.assertAlmostEqual(expected, rel.bin_log_likelihood_ratio(cache, c1, c2, precision))
+            self.assertAlmostEqual(expected, rel.bin_log_likelihood_ratio(cache, c1, c2, precision, False), delta=precision)
+
+        expected = rel.log_likelihood(cache, a1, a2, precision) - sum(log_poisson(0.2, c1) + log_poisson(0.3, c2) for c1, c2 in zip(a1, a2))
+        self.assertAlmostEqual(expected, rel.log_likelihood_ratio(cache, a1, a2, precision))
+
+        self.assertRaises(IndexError, lambda: rel.log_likelihood_ratio(cache, a1, a2[:-1], precision))
+
+    def test_lag_scan(self):
+        precision = 1e-3
+        min_lag, max_lag = -3, 4
+
+        cache = FactorialCache()
+        rng = np.random.default_rng(1)
+        a1 = rng.poisson(2., 40).astype(np.float64)
+        a2 = rng.poisson(1., 45).astype(np.float64)
+
+        rel = DetectorRelation(2., 1., 0.5)
+
+        scan = rel.lag_scan(cache, a1, a2, min_lag, max_lag, precision, likelihood_ratio=True)
+
+        first, last = -min_lag, len(a1)
+        for lag in range(min_lag, max_lag + 1):
+            expected = rel.log_likelihood_ratio(cache, a1[first:last], a2[first + lag:last + lag], precision)
+            self.assertAlmostEqual(expected, scan[lag - min_lag])
+
+        result = rel.lag_search(cache, a1, a2, min_lag, max_lag, precision, likelihood_ratio=True)
+        self.assertAlmostEqual(np.max(scan), result.best_log_likelihood)
+
+if __name__ == "__main__":
+    unittest.main()
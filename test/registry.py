@@ -0,0 +1,118 @@
+import unittest
+import numpy as np
+
+from burstlag import FactorialCache, DetectorRelation, configure_relation_registry, clear_relation_registry, relation_registry_stats
+
+class RegistryTest(unittest.TestCase):
+    def setUp(self):
+        configure_relation_registry()
+        clear_relation_registry()
+
+        self.cache = FactorialCache()
+        self.sig_1 = np.array([250, 190, 3, 210, 201], dtype=np.float64)
+        self.sig_2 = np.array([10, 5, 1, 0, 0], dtype=np.float64)
+
+    def tearDown(self):
+        configure_relation_registry()
+        clear_relation_registry()
+
+    def test_shared(self):
+        precision = 1e-4
+
+        rel = DetectorRelation(200., 0.5, 0.01)
+        flip = DetectorRelation(0.5, 200., 100.)
+        self.assertEqual(1, relation_registry_stats().n_relations)
+
+        value = rel.log_likelihood(self.cache, self.sig_1, self.sig_2, precision)
+        uncached = DetectorRelation(200., 0.5, 0.01).log_likelihood(self.cache, self.sig_1, self.sig_2, precision, False)
+        self.assertEqual(value, uncached)
+
+        # The flip shares the cache in the canonical order, so gives the same values
+        self.assertAlmostEqual(value, flip.log_likelihood(self.cache, self.sig_2, self.sig_1, precision), delta=1e-9)
+        self.assertAlmostEqual(rel.log_likelihood_ratio(self.cache, self.sig_1, self.sig_2, precision),
+            flip.log_likelihood_ratio(self.cache, self.sig_2, self.sig_1, precision), delta=1e-9)
+        self.assertAlmostEqual(rel.lag_scan(self.cache, self.sig_1, self.sig_2, 0, 0, precision, likelihood_ratio=True)[0],
+            flip.lag_scan(self.cache, self.sig_2, self.sig_1, 0, 0, precision, likelihood_ratio=True)[0], delta=1e-9)
+
+        # Completed anytime bins are shared too
+        rel.log_likelihood_anytime(self.cache, self.sig_1, self.sig_2, precision)
+        self.assertEqual(0, DetectorRelation(0.5, 200., 100.).log_likelihood_anytime(self.cache, self.sig_2, self.sig_1, precision).n_terms)
+
+    def test_reciprocal(self):
+        # 1 / (1 / ratio) != ratio for these, but both orders must still share one relation
+        for ratio in [49., 98., 12345.678]:
+            clear_relation_registry()
+            relations = [DetectorRelation(2., 1., ratio), DetectorRelation(1., 2., 1 / ratio)]
+            self.assertEqual(1, relation_registry_stats().n_relations)
+
+            relations = [DetectorRelation(1., 2., 1 / ratio), DetectorRelation(2., 1., ratio)]
+            self.assertEqual(1, relation_registry_stats().n_relations)
+
+    def test_order_independent(self):
+        # With zero tolerance, results must not depend on which order of detectors was requested first
+        for ratio in [49., 98., 12345.678, 0.3]:
+            clear_relation_registry()
+            isolated = DetectorRelation(2., 1., ratio).bin_log_likelihood(self.cache, 3, 1, 1e-3, False)
+            clear_relation_registry()
+            isolated_flip = DetectorRelation(1., 2., 1 / ratio).bin_log_likelihood(self.cache, 1, 3, 1e-3, False)
+
+            clear_relation_registry()
+            flip = DetectorRelation(1., 2., 1 / ratio)
+            rel = DetectorRelation(2., 1., ratio)
+            self.assertEqual(1, relation_registry_stats().n_relations)
+
+            self.assertEqual(isolated, rel.bin_log_likelihood(self.cache, 3, 1, 1e-3, False))
+            self.assertEqual(isolated_flip, flip.bin_log_likelihood(self.cache, 1, 3, 1e-3, False))
+
+    def test_tolerance(self):
+        configure_relation_registry(tolerance=1e-3)
+
+        DetectorRelation(200., 0.5, 0.01)
+        DetectorRelation(200.01, 0.5, 0.01)
+        self.assertEqual(1, relation_registry_stats().n_relations)
+
+        DetectorRelation(201., 0.5, 0.01)
+        self.assertEqual(2, relation_registry_stats().n_relations)
+
+        self.assertRaises(ValueError, lambda: configure_relation_registry(tolerance=-1.))
+
+    def test_budget(self):
+        precision = 1e-4
+
+        rel = DetectorRelation(200., 0.5, 0.01)
+        rel.log_likelihood(self.cache, self.sig_1, self.sig_2, precision)
+
+        # Relations in use are kept regardless of budget, and do not count towards it
+        configure_relation_registry(memory_budget=0)
+        self.assertEqual(0, relation_registry_stats().memory_used)
+
+        # Unused relations take memory even with empty caches, so are dropped as soon as they are no longer used
+        DetectorRelation(10., 10., 1.)
+        self.assertEqual(1, relation_registry_stats().n_relations)
+
+        del rel
+        self.assertEqual(0, relation_registry_stats().n_relations)
+
+        # Within budget, unused relations are kept, and the least recently used are dropped first
+        configure_relation_registry(memory_budget=1 << 20)
+        for i in range(100):
+            DetectorRelation(10., 10., 1. + i)
+        self.assertEqual(100, relation_registry_stats().n_relations)
+
+        DetectorRelation(10., 10., 1.)
+        memory_used = relation_registry_stats().memory_used
+        configure_relation_registry(memory_budget=memory_used // 2)
+
+        n_relations = relation_registry_stats().n_relations
+        self.assertLess(n_relations, 100)
+        self.assertLessEqual(relation_registry_stats().memory_used, memory_used // 2)
+
+        # The relation used most recently was kept, so is not added again, while the oldest was dropped
+        DetectorRelation(10., 10., 1.)
+        self.assertEqual(n_relations, relation_registry_stats().n_relations)
+        DetectorRelation(10., 10., 2.)
+        self.assertEqual(n_relations, relation_registry_stats().n_relations)
+        self.assertLessEqual(relation_registry_stats().memory_used, memory_used // 2)
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,148 @@
+/*
+Replays a histogram archive (see archive/format.hpp) through the likelihood calculation, writing one result per window.
+
+Output is a flat array of little-endian doubles, where value i is for the window starting at bin i * stride.
+It can be read back with e.g. numpy.fromfile(path, dtype="<f8").
+*/
+
+#include "archive/mapped.hpp"
+#include "archive/replay.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+namespace {
+    void usage(char const* program) {
+        std::fprintf(stderr,
+            "Usage: %s ARCHIVE OUTPUT --background RATE_1 RATE_2 --sensitivity-ratio RATIO --window BINS [options]\n"
+            "\n"
+            "  --background RATE_1 RATE_2   Expected background events per bin at each detector\n"
+            "  --sensitivity-ratio RATIO    Expected supernova events at detector 2 relative to detector 1\n"
+            "  --window BINS                Bins per window\n"
+            "  --stride BINS                Bins between window starts (default: window)\n"
+            "  --suppression K              Source suppression prior (default: 1)\n"
+            "  --precision P                Relative precision of each likelihood (default: 0.001)\n"
+            "  --detectors I J              Indices of the detectors in the archive (default: 0 1)\n"
+            "  --threads N                  Threads to evaluate with (default: one per core)\n"
+            "  --ratio                      Output log-likelihood ratios against background only\n",
+            program);
+    }
+
+    /* Parses arguments, exiting with usage on failure */
+    struct Arguments {
+        int argc;
+        char** argv;
+        int i = 1;
+
+        char const* next() {
+            if (i >= argc) {
+                usage(argv[0]);
+                std::exit(2);
+            }
+            return argv[i++];
+        }
+
+        double next_double() {
+            char const* text = next();
+            char* end;
+            double value = std::strtod(text, &end);
+            if (*end != '\0') {
+                std::fprintf(stderr, "Invalid number: %s\n", text);
+                std::exit(2);
+            }
+            return value;
+        }
+
+        size_t next_size() {
+            char const* text = next();
+            char* end;
+            unsigned long long value = std::strtoull(text, &end, 10);
+            if (*end != '\0' || text[0] == '-') {
+                std::fprintf(stderr, "Invalid count: %s\n", text);
+                std::exit(2);
+            }
+            return value;
+        }
+    };
+}
+
+int main(int argc, char** argv) {
+    Arguments args { argc, argv };
+
+    if (argc < 3) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string archive_path = args.next();
+    std::string output_path = args.next();
+
+    RelationParams params { -1, -1, -1, 1 };
+    ReplaySettings settings { 0, 1, 0, 0, 1e-3, false, 0 };
+
+    while (args.i < argc) {
+        std::string option = args.next();
+
+        if (option == "--background") {
+            params.bin_background_rate_1 = args.next_double();
+            params.bin_background_rate_2 = args.next_double();
+        } else if (option == "--sensitivity-ratio") {
+            params.sensitivity_ratio_2_to_1 = args.next_double();
+        } else if (option == "--suppression") {
+            params.source_suppression = args.next_double();
+        } else if (option == "--window") {
+            settings.window_bins = args.next_size();
+        } else if (option == "--stride") {
+            settings.stride_bins = args.next_size();
+        } else if (option == "--precision") {
+            settings.rel_precision = args.next_double();
+        } else if (option == "--detectors") {
+            settings.detector_1 = args.next_size();
+            settings.detector_2 = args.next_size();
+        } else if (option == "--threads") {
+            settings.n_threads = args.next_size();
+        } else if (option == "--ratio") {
+            settings.likelihood_ratio = true;
+        } else {
+            std::fprintf(stderr, "Unknown option: %s\n", option.c_str());
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (params.bin_background_rate_1 < 0 || params.sensitivity_ratio_2_to_1 < 0 || settings.window_bins == 0) {
+        std::fprintf(stderr, "--background, --sensitivity-ratio and --window are required\n");
+        usage(argv[0]);
+        return 2;
+    }
+    if (settings.stride_bins == 0) settings.stride_bins = settings.window_bins;
+
+    std::FILE* output = std::fopen(output_path.c_str(), "wb");
+    if (output == nullptr) {
+        std::fprintf(stderr, "Could not open output: %s\n", output_path.c_str());
+        return 1;
+    }
+
+    int status = 0;
+
+    try {
+        MappedArchive archive(archive_path);
+
+        size_t n_windows = replay_archive(archive, params, settings, [output](scalar const* results, size_t n_results) {
+            if (std::fwrite(results, sizeof(scalar), n_results, output) != n_results) {
+                throw std::runtime_error("Could not write output");
+            }
+        });
+
+        std::fprintf(stderr, "Replayed %zu windows from %zu bins\n", n_windows, static_cast<size_t>(archive.header().n_bins));
+    } catch (std::exception const& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        status = 1;
+    }
+
+    if (std::fclose(output) != 0) status = 1;
+
+    return status;
+}